@@ -48,7 +48,11 @@ extern "C" {
 #include <hal/hal_spi.h>
 #include <dw3000-c0/dw3000_regs.h>
 #include <dw3000-c0/dw3000_stats.h>
+#include <dw3000-c0/dw3000_rxfilter.h>
 #include <dpl/dpl.h>
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+#include <dpl/dpl_cputime.h>
+#endif
 
 #define DWT_DEVICE_ID   (0xDECA0130) //!< Decawave Device ID
 #define DWT_SUCCESS (0)              //!< DWT Success
@@ -119,48 +123,318 @@ struct dw3000_sys_status_backtrace {
 };
 #endif
 
-#if MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)
-#define DW3000_SPI_BT_PTR(_I) _I->spi_bt[_I->spi_bt_idx%MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)]
-#define DW3000_SPI_BT_ADD(_I,_CMD,_CLEN,_DATA,_DLEN,_IS_WR,_NB) if(!_I->spi_bt_lock){struct dw3000_spi_backtrace *p=&_I->spi_bt[++_I->spi_bt_idx%MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)]; \
-        *p = (struct dw3000_spi_backtrace){.utime=dpl_cputime_get32(), .cmd_len=_CLEN, .data_len=_DLEN, .is_write=_IS_WR, .non_blocking=_NB}; \
-        memcpy(p->cmd,_CMD,_CLEN);_I->spi_bt_datap=_DATA;}
-#define DW3000_SPI_BT_ADD_END(_I) if(!_I->spi_bt_lock){struct dw3000_spi_backtrace *p=&DW3000_SPI_BT_PTR(_I); \
-        p->utime_end=dpl_cputime_get32();                                 \
-        memcpy(p->data,_I->spi_bt_datap,(p->data_len>sizeof(p->data))?sizeof(p->data):p->data_len);}
-
-//! DW3000 SPI backtrace structure
-struct dw3000_spi_backtrace {
-    uint32_t utime;
-    uint8_t cmd[4];
-    uint8_t cmd_len;
-    uint8_t is_write:1;
-    uint8_t non_blocking:1;
-    uint8_t data[MYNEWT_VAL(DW3000_SPI_BACKTRACE_DATA_LEN)];
-    uint16_t data_len;
-    uint32_t utime_end;
+#if MYNEWT_VAL(DW3000_TRACE_LEN)
+#if MYNEWT_VAL(DW3000_TRACE_LEN) & (MYNEWT_VAL(DW3000_TRACE_LEN) - 1)
+#error "DW3000_TRACE_LEN must be a power of two"
+#endif
+/* Trace record types, tools/dw3000_trace.py needs to be kept in sync */
+#define DW3000_TRACE_SPI        (0x01)      //!< Spi transfer start, a: cmd[0], b: cmd[1..2], c: length
+#define DW3000_TRACE_SPI_END    (0x02)      //!< Spi transfer end
+#define DW3000_TRACE_IRQ        (0x03)      //!< Interrupt, a: sys_status_hi, c: sys_status
+#define DW3000_TRACE_IRQ_END    (0x04)      //!< Interrupt handled
+#define DW3000_TRACE_WRITE      (0x40)      //!< Spi write flag
+#define DW3000_TRACE_NOBLOCK    (0x80)      //!< Spi nonblocking flag
+
+//! Fixed size binary trace record
+struct dw3000_trace_rec {
+    uint32_t utime;                         //!< dpl_cputime ticks
+    uint8_t type;                           //!< DW3000_TRACE_* type and flags
+    uint8_t a;                              //!< Type specific
+    uint16_t b;                             //!< Type specific
+    uint32_t c;                             //!< Type specific
 };
+
+/* Claims a slot with one atomic increment, safe from both task and interrupt context */
+#define DW3000_TRACE(_I,_T,_A,_B,_C) {struct dw3000_trace_rec *_r = \
+        &(_I)->trace[__atomic_fetch_add(&(_I)->trace_idx, 1, __ATOMIC_RELAXED) & (MYNEWT_VAL(DW3000_TRACE_LEN) - 1)]; \
+        _r->utime = dpl_cputime_get32(); _r->type = (_T); _r->a = (_A); _r->b = (_B); _r->c = (_C);}
+#define DW3000_SPI_TRACE(_I,_CMD,_CLEN,_DLEN,_IS_WR,_NB) \
+        DW3000_TRACE(_I, DW3000_TRACE_SPI | ((_IS_WR) ? DW3000_TRACE_WRITE : 0) | ((_NB) ? DW3000_TRACE_NOBLOCK : 0), \
+                     (_CMD)[0], ((_CLEN) > 1) ? (_CMD)[1] | (((_CLEN) > 2) ? (_CMD)[2] << 8 : 0) : 0, _DLEN)
 #else
-#define DW3000_SPI_BT_PTR(_I) {}
-#define DW3000_SPI_BT_ADD(_I,_CMD,_CLEN,_DATA,_DLEN,_IS_WR,_NB) {}
-#define DW3000_SPI_BT_ADD_END(_I) {}
+#define DW3000_TRACE(_I,_T,_A,_B,_C) {}
+#define DW3000_SPI_TRACE(_I,_CMD,_CLEN,_DLEN,_IS_WR,_NB) {}
 #endif
 
-
+#define DW3000_SPI_TRACE_END(_I) DW3000_TRACE(_I, DW3000_TRACE_SPI_END, 0, 0, 0)
+
+//! Single transfer in a batched SPI transaction
+typedef struct _dw3000_spi_xfer_t{
+    uint8_t cmd[3];                     //!< Transaction header
+    uint8_t cmd_size;                   //!< Length of transaction header
+    uint8_t is_write;                   //!< Write if set, read otherwise
+    uint16_t length;                    //!< Length of data
+    uint8_t * buffer;                   //!< Data source for writes, destination for reads
+    uint8_t data[sizeof(uint64_t)];     //!< Local storage for register sized transfers
+} dw3000_spi_xfer_t;
+
+//! Batch of SPI transfers issued under a single bus acquisition
+typedef struct _dw3000_spi_batch_t{
+    uint8_t count;                                              //!< Number of queued transfers
+    dw3000_spi_xfer_t xfer[MYNEWT_VAL(DW3000_SPI_BATCH_MAX)];   //!< Queued transfers
+} dw3000_spi_batch_t;
+
+#if MYNEWT_VAL(DW3000_MAC_PROFILES)
+//! Maximum number of transfers of a precompiled phy profile
+#define DW3000_PROFILE_XFER_MAX (16)
+
+//! Channel and phy configuration precompiled into a register image, see dw3000_mac_profile_compile
+typedef struct _dw3000_mac_profile_t{
+    uint8_t count;                                      //!< Number of transfers, 0 if not compiled
+    uint32_t sys_cfg;                                   //!< SYS_CFG bits owned by the profile
+    uint32_t tx_fctrl;                                  //!< TX_FCTRL preamble length, prf and data rate
+    uint8_t drx_tune[10];                               //!< DRX_TUNE0b to DRX_TUNE2 image
+    dw3000_spi_xfer_t xfer[DW3000_PROFILE_XFER_MAX];    //!< Precomputed transfers
+    struct uwb_dev_config config;                       //!< Configuration the profile was compiled from
+} dw3000_mac_profile_t;
+#endif
 
 struct _dw3000_dev_instance_t;
 
+//! SPI bus arbitration classes, lower values are more urgent
+typedef enum _dw3000_spi_prio_t{
+    DW3000_SPI_PRIO_IRQ = 0,            //!< Interrupt and timestamp critical
+    DW3000_SPI_PRIO_MAC,                //!< MAC control
+    DW3000_SPI_PRIO_BULK,               //!< Bulk and diagnostic, preemptible between chunks
+    DW3000_SPI_PRIO_NUM
+} dw3000_spi_prio_t;
+
+//! System clock domain of the device, decides the fastest legal spi baudrate
+typedef enum _dw3000_clk_state_t{
+    DW3000_CLK_INIT = 0,                //!< After reset or wakeup, on XTAL until the PLL locks
+    DW3000_CLK_XTAL,                    //!< System clock forced to XTAL
+    DW3000_CLK_PLL,                     //!< System clock on the locked PLL, full speed spi
+    DW3000_CLK_SLEEP,                   //!< Sleeping
+    DW3000_CLK_TEST                     //!< Test modes with sequencing disabled, low speed until reset
+} dw3000_clk_state_t;
+
+//! Events driving the clock domain state machine, see dw3000_clk_event
+typedef enum _dw3000_clk_event_t{
+    DW3000_CLK_EV_RESET = 0,            //!< Hard or soft reset
+    DW3000_CLK_EV_XTAL,                 //!< System clock forced to XTAL
+    DW3000_CLK_EV_PLL,                  //!< System clock forced to PLL, low speed until locked
+    DW3000_CLK_EV_SEQ,                  //!< System clock handed to the sequencer, low speed until locked
+    DW3000_CLK_EV_PLL_LOCK,             //!< Clock PLL lock seen
+    DW3000_CLK_EV_SLEEP,                //!< Entering sleep
+    DW3000_CLK_EV_WAKEUP,               //!< Woken up from sleep
+    DW3000_CLK_EV_TEST                  //!< Entering a test mode, CW or repeated frames
+} dw3000_clk_event_t;
+
+//! Radio control fast commands, precomputed SYS_CTRL writes, see dw3000_fast_cmd
+typedef enum _dw3000_fast_cmd_t{
+    DW3000_FCMD_TX = 0,                 //!< Start transmitting now
+    DW3000_FCMD_TX_DLY,                 //!< Delayed transmit, TX + 1
+    DW3000_FCMD_TX_W4R,                 //!< Transmit and wait for response, TX + 2
+    DW3000_FCMD_TX_DLY_W4R,             //!< Delayed transmit and wait for response, TX + 3
+    DW3000_FCMD_RX,                     //!< Enable receiver now
+    DW3000_FCMD_RX_DLY,                 //!< Delayed receiver enable, RX + 1
+    DW3000_FCMD_RX_W4R,                 //!< Enable receiver, wait for response, RX + 2
+    DW3000_FCMD_RX_DLY_W4R,             //!< Delayed receiver enable, wait for response, RX + 3
+    DW3000_FCMD_TRXOFF,                 //!< Transceiver off
+    DW3000_FCMD_TX_TRXOFF,              //!< Start and abort a transmission, initialises the SFD
+    DW3000_FCMD_HRBT,                   //!< Toggle the host side receive buffer pointer
+    DW3000_FCMD_NUM
+} dw3000_fast_cmd_t;
+
+#define DW3000_FCMD_DLY     (1)         //!< Offset of the delayed variant of TX and RX fast commands
+#define DW3000_FCMD_W4R     (2)         //!< Offset of the wait for response variant of TX and RX fast commands
+
+//! Completion callback of an asynchronous SPI transfer, called from interrupt context
+typedef void (*dw3000_spi_async_cb_t)(struct _dw3000_dev_instance_t * inst, void * arg, int rc);
+
+//! Asynchronous SPI transfer, must remain valid until its callback has been called
+typedef struct _dw3000_spi_async_t{
+    uint8_t cmd[3];                     //!< Transaction header
+    uint8_t cmd_size;                   //!< Length of transaction header
+    uint8_t is_write;                   //!< Write if set, read otherwise
+    uint16_t length;                    //!< Length of data
+    uint8_t * buffer;                   //!< Data source for writes, destination for reads
+    dw3000_spi_async_cb_t cb;           //!< Completion callback, may be NULL
+    void * cb_arg;                      //!< Argument passed to cb
+    uint16_t offset;                    //!< Bytes of data transferred so far
+    uint16_t chunk;                     //!< Size of chunk in flight
+    uint8_t cmd_done;                   //!< Set once the header has been sent
+    struct _dw3000_spi_async_t * next;  //!< Next queued transfer
+} dw3000_spi_async_t;
+
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+//! State of the interrupt top half, see dw3000_irq
+typedef enum _dw3000_irq_th_state_t{
+    DW3000_IRQ_TH_IDLE = 0,             //!< Bottom half idle, the next interrupt starts a capture
+    DW3000_IRQ_TH_CAPTURE,              //!< Capture in flight, its completion queues the bottom half
+    DW3000_IRQ_TH_READY,                //!< Capture complete, bottom half queued
+    DW3000_IRQ_TH_BUSY                  //!< Bottom half running, interrupts are queued without capture
+} dw3000_irq_th_state_t;
+
+//! Registers read from the interrupt handler for the bottom half
+typedef struct _dw3000_irq_capture_t{
+    dw3000_spi_async_t xfer[3];                 //!< Chained SYS_STATUS, RX_FINFO and RX_TIME reads
+    uint8_t sys_status[SYS_STATUS_LEN];         //!< SYS_STATUS at the time of the interrupt
+    uint8_t rx_finfo[RX_FINFO_LEN];             //!< RX_FINFO at the time of the interrupt
+    uint8_t rx_stamp[RX_TIME_RX_STAMP_LEN];     //!< RX_TIME adjusted timestamp at the time of the interrupt
+    volatile uint8_t state;                     //!< See dw3000_irq_th_state_t
+    uint8_t valid;                              //!< Bottom half in progress uses the captured registers
+    int rc;                                     //!< First error of the capture in flight
+} dw3000_irq_capture_t;
+#endif
+
+//! Host owned registers mirrored in the register shadow cache
+typedef enum _dw3000_shadow_id_t{
+    DW3000_SHADOW_SYS_CFG = 0,          //!< SYS_CFG_ID
+    DW3000_SHADOW_SYS_MASK,             //!< SYS_MASK_ID
+    DW3000_SHADOW_PMSC_CTRL1,           //!< PMSC_ID:PMSC_CTRL1_OFFSET
+    DW3000_SHADOW_AON_WCFG,             //!< AON_ID:AON_WCFG_OFFSET
+    DW3000_SHADOW_AON_CFG0,             //!< AON_ID:AON_CFG0_OFFSET
+    DW3000_SHADOW_GPIO_MODE,            //!< GPIO_CTRL_ID:GPIO_MODE_OFFSET
+    DW3000_SHADOW_GPIO_DIR,             //!< GPIO_CTRL_ID:GPIO_DIR_OFFSET
+    /* Written by dw3000_mac_config, only rewritten when they change */
+    DW3000_SHADOW_LDE_REPC,             //!< LDE_IF_ID:LDE_REPC_OFFSET
+    DW3000_SHADOW_FS_PLLCFG,            //!< FS_CTRL_ID:FS_PLLCFG_OFFSET
+    DW3000_SHADOW_FS_PLLTUNE,           //!< FS_CTRL_ID:FS_PLLTUNE_OFFSET
+    DW3000_SHADOW_RF_RXCTRLH,           //!< RF_CONF_ID:RF_RXCTRLH_OFFSET
+    DW3000_SHADOW_RF_TXCTRL,            //!< RF_CONF_ID:RF_TXCTRL_OFFSET
+    DW3000_SHADOW_DRX_TUNE0b,           //!< DRX_CONF_ID:DRX_TUNE0b_OFFSET
+    DW3000_SHADOW_DRX_TUNE1a,           //!< DRX_CONF_ID:DRX_TUNE1a_OFFSET
+    DW3000_SHADOW_DRX_TUNE1b,           //!< DRX_CONF_ID:DRX_TUNE1b_OFFSET
+    DW3000_SHADOW_DRX_TUNE2,            //!< DRX_CONF_ID:DRX_TUNE2_OFFSET
+    DW3000_SHADOW_DRX_TUNE4H,           //!< DRX_CONF_ID:DRX_TUNE4H_OFFSET
+    DW3000_SHADOW_DRX_SFDTOC,           //!< DRX_CONF_ID:DRX_SFDTOC_OFFSET
+    DW3000_SHADOW_AGC_TUNE1,            //!< AGC_CTRL_ID:AGC_TUNE1_OFFSET
+    DW3000_SHADOW_AGC_TUNE2,            //!< AGC_CTRL_ID:AGC_TUNE2_OFFSET
+    DW3000_SHADOW_USR_SFD,              //!< USR_SFD_ID:0, sfd length
+    DW3000_SHADOW_CHAN_CTRL,            //!< CHAN_CTRL_ID
+    DW3000_SHADOW_NUM
+} dw3000_shadow_id_t;
+
+//! Mac interface callbacks dispatched by the driver, see dw3000_mac_interface_dispatch
+typedef enum _dw3000_cb_id_t{
+    DW3000_CB_RX_COMPLETE,              //!< rx_complete_cb
+    DW3000_CB_TX_BEGINS,                //!< tx_begins_cb
+    DW3000_CB_TX_COMPLETE,              //!< tx_complete_cb
+    DW3000_CB_RX_TIMEOUT,               //!< rx_timeout_cb
+    DW3000_CB_RX_ERROR,                 //!< rx_error_cb
+    DW3000_CB_CIR_COMPLETE,             //!< cir_complete_cb
+    DW3000_CB_SLEEP,                    //!< sleep_cb
+    DW3000_CB_RESET,                    //!< reset_cb
+    DW3000_CB_NUM
+} dw3000_cb_id_t;
+
+//! Mac interface callback, returns true to stop where the event allows it
+typedef bool (* dw3000_cb_fn_t)(struct uwb_dev * udev, struct uwb_mac_interface * cbs);
+
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+//! Adaptive interrupt polling, see DW3000_IRQ_POLL_RATE
+typedef struct _dw3000_irq_poll_t{
+    struct hal_timer timer;             //!< Queues the bottom half in polling mode
+    uint32_t win_start;                 //!< Start of the rate measurement window, cputime ticks
+    uint16_t win_cnt;                   //!< Interrupts in the current window
+    volatile uint16_t irq_cnt;          //!< Interrupts since the last bottom half, counted by the isr
+    uint8_t active;                     //!< Irq pin interrupt disabled, polling
+    uint8_t user_off;                   //!< Irq pin interrupt disabled with dw3000_irq_disable
+    uint8_t idle;                       //!< Consecutive polls without a pending event
+} dw3000_irq_poll_t;
+#endif
+
+#if MYNEWT_VAL(DW3000_CB_DISPATCH_MAX)
+//! Callback of one interface in a dispatch table
+typedef struct _dw3000_cb_entry_t{
+    dw3000_cb_fn_t fn;                  //!< Callback
+    struct uwb_mac_interface * cbs;     //!< Interface it belongs to
+} dw3000_cb_entry_t;
+
+//! Per event callback tables built from uwb_dev.interface_cbs
+typedef struct _dw3000_cb_table_t{
+    uint8_t valid;                      //!< Tables built by dw3000_mac_interface_update
+    uint8_t count[DW3000_CB_NUM];       //!< Entries per event, 0xFF if the event walks the list
+    dw3000_cb_entry_t entry[DW3000_CB_NUM][MYNEWT_VAL(DW3000_CB_DISPATCH_MAX)]; //!< Callbacks in list order
+} dw3000_cb_table_t;
+#endif
+
+#if MYNEWT_VAL(DW3000_RX_LAZY_HDR)
+/**
+ * Rx header callback, called from the interrupt task with the first rx_fetched bytes of
+ * a received frame in uwb_dev.rxbuf, before the frame is released to the receiver.
+ * Returns the number of frame bytes needed, the remainder is not read and uwb_dev.frame_len
+ * is cut to the bytes read. There is one callback per instance, it decides for the frames
+ * of all mac interfaces.
+ */
+typedef uint16_t (*dw3000_rx_hdr_cb_t)(struct _dw3000_dev_instance_t * inst, void * arg);
+#endif
+
+#if MYNEWT_VAL(DW3000_RX_DEMUX_MAX)
+//! Rx demultiplexer rule, see dw3000_rx_demux_add
+typedef struct _dw3000_rx_demux_rule_t{
+    uint16_t fctrl_mask;                //!< Frame control bits compared
+    uint16_t fctrl;                     //!< Expected value of the compared frame control bits
+    uint16_t offset;                    //!< Offset in the frame of the compared payload bytes
+    uint8_t len;                        //!< Number of payload bytes compared, 0 to 4
+    uint32_t mask;                      //!< Payload bits compared, little endian
+    uint32_t value;                     //!< Expected value of the compared payload bits
+    struct uwb_mac_interface * cbs;     //!< Owning interface, gets the matching frames
+} dw3000_rx_demux_rule_t;
+
+//! Compiled rx demultiplexer rule
+typedef struct _dw3000_rx_demux_entry_t{
+    uint16_t fctrl_mask;                //!< Frame control bits compared
+    uint16_t fctrl;                     //!< Expected frame control bits
+    uint16_t offset;                    //!< Offset of the compared payload bytes
+    uint16_t min_len;                   //!< Shortest frame containing the compared bytes
+    uint32_t mask;                      //!< Payload bits compared, limited to len bytes
+    uint32_t value;                     //!< Expected payload bits
+    struct uwb_mac_interface * cbs;     //!< Owning interface
+} dw3000_rx_demux_entry_t;
+#endif
+
+#if MYNEWT_VAL(DW3000_RX_FILTER_MAX)
+//! Software frame filter of an instance
+typedef struct _dw3000_rx_filter_t{
+    dw3000_rx_filter_prog_t prog;       //!< Program, only changed with uwb_dev.irq_sem held
+    uint8_t active;                     //!< Filter set, frames are passed unfiltered otherwise
+} dw3000_rx_filter_t;
+#endif
+
+#if MYNEWT_VAL(DW3000_RX_RING_LEN)
+//! Received frame queued in the rx ring, see dw3000_rx_ring_get
+typedef struct _dw3000_rx_desc_t{
+    uint64_t rxtimestamp;                       //!< Adjusted rx timestamp
+    int32_t carrier_integrator;                 //!< Carrier integrator, 0 in double buffer mode
+    uint16_t fctrl;                             //!< Frame control
+    uint16_t frame_len;                         //!< Frame length without crc
+    uint16_t len;                               //!< Bytes in payload, frame_len truncated to the descriptor size
+    dw3000_dev_rxdiag_t rxdiag;                 //!< Receive diagnostics, if rxdiag_enable
+    uint8_t payload[MYNEWT_VAL(DW3000_RX_RING_FRAME_MAX)]; //!< Frame, first bytes only if truncated
+} dw3000_rx_desc_t;
+#endif
+
 //! Device instance parameters.
 typedef struct _dw3000_dev_instance_t{
     struct uwb_dev uwb_dev;                     //!< Common generalising struct uwb_dev
 
     struct dpl_sem * spi_sem;                   //!< Pointer to global spi bus semaphore
     struct dpl_sem spi_nb_sem;                  //!< Semaphore for nonblocking rd/wr operations
+    void * spi_irq_task;                        //!< Task running the interrupt bottom half, see hal_dw3000_spi_prio
     int spi_baudrate;                           //!< SPI Baudrate (<20MHz)
     int spi_baudrate_low;                       //!< Low SPI Baudrate (<2MHz)
     uint8_t spi_num;                            //!< SPI number
     uint8_t irq_pin;                            //!< Interrupt request pin
     uint8_t ss_pin;                             //!< Slave select pin
     uint8_t rst_pin;                            //!< Reset pin
+    uint16_t spi_rd_max_noblock;                //!< Transfers shorter than this use blocking io
+    uint8_t clk_state;                          //!< Clock domain of the device, see dw3000_clk_state_t
+#if MYNEWT_VAL(DW3000_SPI_WRITE_VERIFY)
+    int spi_baudrate_max;                       //!< Configured SPI Baudrate, limit of the write verification step up
+    uint8_t spi_wv_errs;                        //!< Consecutive write verification mismatches since the last good write
+    uint16_t spi_wv_good;                       //!< Consecutive verified writes since the last baudrate change
+    struct dpl_event spi_tune_ev;               //!< Measures the non-blocking crossover after a baudrate change
+#endif
+#if MYNEWT_VAL(DW3000_SPI_WC_MAX)
+    uint8_t wc_active;                          //!< Write combining enabled, see dw3000_wc_begin
+    void * wc_task;                             //!< Task whose writes are combined
+    uint8_t wc_reg;                             //!< Register file of the pending combined write
+    uint16_t wc_sub;                            //!< Subaddress of the pending combined write
+    uint16_t wc_len;                            //!< Length of the pending combined write, 0 if none
+    uint8_t wc_buf[MYNEWT_VAL(DW3000_SPI_WC_MAX)]; //!< Data of the pending combined write
+#endif
 
     struct dpl_sem tx_sem;                      //!< semphore for low level mac/phy functions
     struct dpl_mutex mutex;                     //!< mutex
@@ -177,6 +451,54 @@ typedef struct _dw3000_dev_instance_t{
     uint8_t  sys_status_hi;        //!< SYS_STATUS_ID+4 for current event
 
     struct hal_spi_settings spi_settings;  //!< Structure of SPI settings in hal layer
+#if MYNEWT_VAL(DW3000_HAL_SPI_ZERO_COPY_MIN) || MYNEWT_VAL(DW3000_HAL_SPI_ASYNC)
+    uint8_t spi_cmd_rx[4];                      //!< Discards what the device returns during a DMA'd command phase
+#endif
+#if !defined(MYNEWT) && MYNEWT_VAL(DW3000_HAL_SPIDEV)
+    int spidev_fd;                              //!< spidev file descriptor, -1 until opened
+#endif
+#if MYNEWT_VAL(DW3000_HAL_SPI_ASYNC)
+    dw3000_spi_async_t * async_head;            //!< Asynchronous transfer in progress
+    dw3000_spi_async_t * async_tail;            //!< Last queued asynchronous transfer
+#endif
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+    dw3000_irq_capture_t irq_th;                //!< Registers read by the interrupt top half
+#endif
+#if MYNEWT_VAL(DW3000_REG_SHADOW)
+    uint8_t shadow[DW3000_SHADOW_NUM][sizeof(uint32_t)]; //!< Shadow copies of host owned registers
+    uint32_t shadow_valid;                              //!< Bitmask of valid entries in shadow
+#endif
+#if MYNEWT_VAL(DW3000_MAC_PROFILES)
+    dw3000_mac_profile_t profiles[MYNEWT_VAL(DW3000_MAC_PROFILES)]; //!< Precompiled phy profiles
+    uint8_t profile;                                    //!< Last applied profile, 0xFF if none
+#endif
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+    dw3000_irq_poll_t irq_poll;                 //!< Adaptive interrupt polling state
+#endif
+#if MYNEWT_VAL(DW3000_CB_DISPATCH_MAX)
+    dw3000_cb_table_t cb_table;                 //!< Mac interface callbacks per event
+#endif
+#if MYNEWT_VAL(DW3000_RX_DEMUX_MAX)
+    dw3000_rx_demux_entry_t demux[MYNEWT_VAL(DW3000_RX_DEMUX_MAX)];   //!< Compiled rx demultiplexer rules
+    uint8_t demux_count;                        //!< Number of rules in demux
+    uint16_t demux_hdr;                         //!< Frame bytes needed to evaluate all rules
+#endif
+#if MYNEWT_VAL(DW3000_RX_FILTER_MAX)
+    dw3000_rx_filter_t rx_filter;               //!< Compiled software frame filter
+#endif
+#if MYNEWT_VAL(DW3000_RX_LAZY_HDR)
+    dw3000_rx_hdr_cb_t rx_hdr_cb;               //!< Rx header callback, NULL to always read whole frames
+    void * rx_hdr_arg;                          //!< Argument of rx_hdr_cb
+    uint16_t rx_fetched;                        //!< Bytes of the current frame read into uwb_dev.rxbuf
+    uint16_t rx_frame_len;                      //!< Length of the current frame as received, uwb_dev.frame_len may be cut
+#endif
+#if MYNEWT_VAL(DW3000_RX_RING_LEN)
+    dw3000_rx_desc_t rx_ring[MYNEWT_VAL(DW3000_RX_RING_LEN)];  //!< Received frames not yet consumed
+    volatile uint16_t rx_ring_head;             //!< Descriptors filled, free running
+    volatile uint16_t rx_ring_tail;             //!< Descriptors released, free running
+    volatile uint8_t rx_ring_attached;          //!< A consumer takes frames from the ring, see dw3000_rx_ring_attach
+    struct dpl_sem rx_ring_sem;                 //!< Counts descriptors not yet taken by dw3000_rx_ring_get
+#endif
 #if MYNEWT_VAL(CIR_ENABLED)
     struct cir_dw3000_instance * cir;           //!< CIR instance (duplicate of uwb_dev->cir)
 #endif
@@ -194,13 +516,11 @@ typedef struct _dw3000_dev_instance_t{
     uint16_t sys_status_bt_idx;
     uint8_t sys_status_bt_lock;
 #endif
-#if MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)
-    struct dw3000_spi_backtrace spi_bt[MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)];
-    uint16_t spi_bt_idx;
-    uint8_t spi_bt_lock;
-    uint8_t* spi_bt_datap;
+#if MYNEWT_VAL(DW3000_TRACE_LEN)
+    struct dw3000_trace_rec trace[MYNEWT_VAL(DW3000_TRACE_LEN)];    //!< Binary trace ring
+    uint32_t trace_idx;                                             //!< Next slot, free running
 #endif
-#if MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN) || MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)
+#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)
     /* To allow translation from ticks to usecs in gdb during backtrace*/
     uint32_t bt_ticks2usec;
 #endif
@@ -228,8 +548,33 @@ int dw3000_dev_config(dw3000_dev_instance_t * inst);
 void dw3000_softreset(dw3000_dev_instance_t * inst);
 struct uwb_dev_status dw3000_read(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length);
 struct uwb_dev_status dw3000_write(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length);
+struct uwb_dev_status dw3000_read_bulk(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length);
 uint64_t dw3000_read_reg(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, size_t nsize);
 void dw3000_write_reg(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint64_t val, size_t nsize);
+uint64_t dw3000_read_reg_cached(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, size_t nbytes);
+void dw3000_write_reg_diff(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint64_t val, size_t nbytes);
+void dw3000_shadow_invalidate(dw3000_dev_instance_t * inst);
+void dw3000_spi_tune_noblock(dw3000_dev_instance_t * inst);
+void dw3000_clk_event(dw3000_dev_instance_t * inst, dw3000_clk_event_t ev);
+void dw3000_clk_check_lock(dw3000_dev_instance_t * inst);
+struct uwb_dev_status dw3000_fast_cmd(dw3000_dev_instance_t * inst, dw3000_fast_cmd_t cmd);
+void dw3000_wc_begin(dw3000_dev_instance_t * inst);
+void dw3000_wc_end(dw3000_dev_instance_t * inst);
+void dw3000_spi_async_init(dw3000_spi_async_t * xfer, uint16_t reg, uint16_t subaddress, uint8_t operation,
+                           uint8_t * buffer, uint16_t length, dw3000_spi_async_cb_t cb, void * cb_arg);
+struct uwb_dev_status dw3000_read_async(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length,
+                                        dw3000_spi_async_t * xfer, dw3000_spi_async_cb_t cb, void * cb_arg);
+struct uwb_dev_status dw3000_write_async(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length,
+                                         dw3000_spi_async_t * xfer, dw3000_spi_async_cb_t cb, void * cb_arg);
+void dw3000_spi_xfer_init(dw3000_spi_xfer_t * x, uint16_t reg, uint16_t subaddress, uint8_t operation, uint8_t * buffer, uint16_t length);
+struct uwb_dev_status dw3000_spi_xfer_submit(dw3000_dev_instance_t * inst, dw3000_spi_xfer_t * xfer, uint8_t count);
+void dw3000_spi_batch_init(dw3000_spi_batch_t * batch);
+int dw3000_spi_batch_read(dw3000_spi_batch_t * batch, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length);
+int dw3000_spi_batch_write(dw3000_spi_batch_t * batch, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length);
+int dw3000_spi_batch_read_reg(dw3000_spi_batch_t * batch, uint16_t reg, uint16_t subaddress, size_t nbytes);
+int dw3000_spi_batch_write_reg(dw3000_spi_batch_t * batch, uint16_t reg, uint16_t subaddress, uint64_t val, size_t nbytes);
+uint64_t dw3000_spi_batch_value(dw3000_spi_batch_t * batch, int idx);
+struct uwb_dev_status dw3000_spi_batch_submit(dw3000_dev_instance_t * inst, dw3000_spi_batch_t * batch);
 void dw3000_dev_set_sleep_timer(dw3000_dev_instance_t * inst, uint16_t count);
 void dw3000_dev_configure_sleep(dw3000_dev_instance_t * inst);
 struct uwb_dev_status dw3000_dev_enter_sleep(dw3000_dev_instance_t * inst);
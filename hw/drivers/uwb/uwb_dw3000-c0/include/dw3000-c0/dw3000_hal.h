@@ -41,15 +41,30 @@ extern "C" {
 
 struct _dw3000_dev_instance_t * hal_dw3000_inst(uint8_t idx);     //!< Structure of hal instances.
 void hal_dw3000_reset(struct _dw3000_dev_instance_t * inst);
+uint8_t hal_dw3000_spi_prio(struct _dw3000_dev_instance_t * inst);
+int hal_dw3000_bus_acquire(struct _dw3000_dev_instance_t * inst, uint8_t prio);
+int hal_dw3000_bus_release(struct _dw3000_dev_instance_t * inst);
 int hal_dw3000_read(struct _dw3000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length);
+int hal_dw3000_read_prio(struct _dw3000_dev_instance_t * inst, uint8_t prio, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length);
 int hal_dw3000_read_noblock(struct _dw3000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length);
+int hal_dw3000_read_noblock_prio(struct _dw3000_dev_instance_t * inst, uint8_t prio, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length);
 int hal_dw3000_write(struct _dw3000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length);
 int hal_dw3000_write_noblock(struct _dw3000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length);
+int hal_dw3000_batch(struct _dw3000_dev_instance_t * inst, dw3000_spi_xfer_t * xfers, uint8_t count);
+int hal_dw3000_async_submit(struct _dw3000_dev_instance_t * inst, dw3000_spi_async_t * xfer);
+int hal_dw3000_async_try_submit(struct _dw3000_dev_instance_t * inst, dw3000_spi_async_t * xfer);
 int hal_dw3000_rw_noblock_wait(struct _dw3000_dev_instance_t * inst, uint32_t timeout_ms);
 
 int hal_dw3000_wakeup(struct _dw3000_dev_instance_t * inst);
 int hal_dw3000_get_rst(struct _dw3000_dev_instance_t * inst);
 void hal_dw3000_spi_txrx_cb(void *arg, int len);
+void hal_dw3000_spi_unbind(struct _dw3000_dev_instance_t * inst);
+#if MYNEWT_VAL(DW3000_SPI_WC_MAX)
+int hal_dw3000_wc_flush(struct _dw3000_dev_instance_t * inst);
+#endif
+#if !defined(MYNEWT) && MYNEWT_VAL(DW3000_HAL_SPIDEV)
+void hal_dw3000_spidev_close(struct _dw3000_dev_instance_t * inst);
+#endif
 #ifdef __cplusplus
 }
 #endif
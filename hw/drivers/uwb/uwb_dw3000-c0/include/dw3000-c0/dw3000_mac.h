@@ -121,7 +121,35 @@ typedef struct _dw3000_mac_deviceentcnts_t{
 
 
 struct uwb_dev_status dw3000_mac_init(struct _dw3000_dev_instance_t * inst, struct uwb_dev_config * config);
+void dw3000_irq_disable(struct _dw3000_dev_instance_t * inst);
+void dw3000_irq_enable(struct _dw3000_dev_instance_t * inst);
 struct uwb_dev_status dw3000_mac_config(struct _dw3000_dev_instance_t * inst, struct uwb_dev_config * config);
+#if MYNEWT_VAL(DW3000_MAC_PROFILES)
+int dw3000_mac_profile_compile(struct _dw3000_dev_instance_t * inst, uint8_t id, struct uwb_dev_config * config);
+struct uwb_dev_status dw3000_mac_profile_apply(struct _dw3000_dev_instance_t * inst, uint8_t id);
+#endif
+#if MYNEWT_VAL(DW3000_CB_DISPATCH_MAX)
+void dw3000_mac_interface_update(struct _dw3000_dev_instance_t * inst);
+#endif
+void dw3000_mac_interface_dispatch(struct _dw3000_dev_instance_t * inst, dw3000_cb_id_t id, bool stop);
+#if MYNEWT_VAL(DW3000_RX_LAZY_HDR)
+void dw3000_rx_set_hdr_cb(struct _dw3000_dev_instance_t * inst, dw3000_rx_hdr_cb_t cb, void * arg);
+#endif
+#if MYNEWT_VAL(DW3000_RX_DEMUX_MAX)
+int dw3000_rx_demux_add(struct _dw3000_dev_instance_t * inst, const dw3000_rx_demux_rule_t * rule);
+void dw3000_rx_demux_remove(struct _dw3000_dev_instance_t * inst, struct uwb_mac_interface * cbs);
+void dw3000_rx_demux_clear(struct _dw3000_dev_instance_t * inst);
+#endif
+#if MYNEWT_VAL(DW3000_RX_FILTER_MAX)
+int dw3000_rx_filter_compile(struct _dw3000_dev_instance_t * inst, const dw3000_rx_filter_rule_t * rules, uint8_t nrules, bool accept);
+void dw3000_rx_filter_clear(struct _dw3000_dev_instance_t * inst);
+#endif
+#if MYNEWT_VAL(DW3000_RX_RING_LEN)
+void dw3000_rx_ring_attach(struct _dw3000_dev_instance_t * inst);
+void dw3000_rx_ring_detach(struct _dw3000_dev_instance_t * inst);
+dw3000_rx_desc_t * dw3000_rx_ring_get(struct _dw3000_dev_instance_t * inst, dpl_time_t timeout);
+void dw3000_rx_ring_release(struct _dw3000_dev_instance_t * inst);
+#endif
 void dw3000_tasks_init(struct _dw3000_dev_instance_t * inst);
 struct uwb_dev_status dw3000_mac_framefilter(struct _dw3000_dev_instance_t * inst, uint16_t enable);
 struct uwb_dev_status dw3000_write_tx(struct _dw3000_dev_instance_t * inst,  uint8_t *txFrameBytes, uint16_t txBufferOffset, uint16_t txFrameLength);
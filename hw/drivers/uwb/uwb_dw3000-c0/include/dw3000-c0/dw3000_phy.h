@@ -72,6 +72,7 @@ void dw3000_phy_sysclk_PLL(struct _dw3000_dev_instance_t * inst);
 void dw3000_phy_sysclk_SEQ(struct _dw3000_dev_instance_t * inst);
 void dw3000_phy_sysclk_ACC(struct _dw3000_dev_instance_t * inst, uint8_t mode);
 void dw3000_phy_disable_sequencing(struct _dw3000_dev_instance_t * inst);
+void dw3000_phy_lde_params(int prfIndex, uint8_t * cfg1, uint16_t * cfg2);
 void dw3000_phy_config_lde(struct _dw3000_dev_instance_t * inst, int prfIndex);
 void dw3000_phy_config_txrf(struct _dw3000_dev_instance_t * inst, struct uwb_dev_txrf_config * config);
 void dw3000_phy_rx_reset(struct _dw3000_dev_instance_t * inst);
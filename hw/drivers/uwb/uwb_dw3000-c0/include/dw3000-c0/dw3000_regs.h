@@ -1006,6 +1006,8 @@ extern "C" {
 
 /* offset from TX_CAL_ID in bytes */
 #define RF_STATUS_OFFSET        0x2C
+#define RF_STATUS_LEN           (4)
+#define RF_STATUS_CPLLLOCK      0x01UL          /* Clock PLL lock status, not latched */
 
 /****************************************************************************//**
  * @brief Bit definitions for register
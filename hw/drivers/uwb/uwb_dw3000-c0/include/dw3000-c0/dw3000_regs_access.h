@@ -0,0 +1,160 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw3000_regs_access.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2020
+ * @brief Typed register accessors
+ *
+ * @details Register fields used in the hot paths are described once in DW3000_REG_TABLE
+ * using the definitions of dw3000_regs.h. For each entry a dw3000_rd_<name>() and a
+ * dw3000_wr_<name>() static inline accessor is generated. Command headers, lengths and
+ * access masks are compile-time constants, so a call compiles down to a single hal
+ * transfer with a constant command and no run-time argument checks.
+ *
+ */
+
+#ifndef _DW3000_REGS_ACCESS_H_
+#define _DW3000_REGS_ACCESS_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <dw3000-c0/dw3000_regs.h>
+#include <dw3000-c0/dw3000_dev.h>
+#include <dw3000-c0/dw3000_hal.h>
+
+//! Command header of a register access, operation 0 for read and 1 for write
+#define DW3000_CMD_HDR(_OP, _REG, _SUB) \
+    (uint8_t)((_OP) << 7 | ((_SUB) != 0) << 6 | (_REG)), \
+    (uint8_t)(((_SUB) > 0x7F) << 7 | ((_SUB) & 0x7F)), \
+    (uint8_t)((_SUB) >> 7)
+//! Length of the command header of a register access
+#define DW3000_CMD_LEN(_SUB) ((_SUB) ? (((_SUB) > 0x7F) ? 3 : 2) : 1)
+//! Access mask covering all bytes of a field
+#define DW3000_REG_MASK_ALL(_LEN) (((_LEN) >= 8) ? ~0ULL : ((1ULL << (8 * (_LEN))) - 1))
+
+//! Writes bypass dw3000_write_reg, set for fields not in the shadow cache or spi write verification
+#define DW3000_REG_DIRECT       (1)
+#define DW3000_REG_DIRECT_WV   (!MYNEWT_VAL(DW3000_SPI_WRITE_VERIFY))
+
+/**
+ * Register field descriptions: name, register file, offset, width in bytes,
+ * access mask for writes (unused bits are always written as zero) and whether
+ * writes can go straight to the hal.
+ */
+#define DW3000_REG_TABLE(X) \
+    X(sys_status,       SYS_STATUS_ID,  0,  4,  SYS_STATUS_MASK_32,     DW3000_REG_DIRECT)      \
+    X(sys_status_b0,    SYS_STATUS_ID,  0,  1,  DW3000_REG_MASK_ALL(1), DW3000_REG_DIRECT)      \
+    X(sys_status_b1,    SYS_STATUS_ID,  1,  1,  DW3000_REG_MASK_ALL(1), DW3000_REG_DIRECT)      \
+    X(sys_status_b2,    SYS_STATUS_ID,  2,  1,  DW3000_REG_MASK_ALL(1), DW3000_REG_DIRECT)      \
+    X(sys_status_b3,    SYS_STATUS_ID,  3,  1,  DW3000_REG_MASK_ALL(1), DW3000_REG_DIRECT)      \
+    X(sys_status_b34,   SYS_STATUS_ID,  3,  2,  DW3000_REG_MASK_ALL(2), DW3000_REG_DIRECT)      \
+    X(sys_status_hi,    SYS_STATUS_ID,  4,  1,  DW3000_REG_MASK_ALL(1), DW3000_REG_DIRECT)      \
+    X(rx_finfo,         RX_FINFO_ID,    RX_FINFO_OFFSET,  4,  RX_FINFO_MASK_32,  DW3000_REG_DIRECT) \
+    X(rx_finfo_lo16,    RX_FINFO_ID,    RX_FINFO_OFFSET,  2,  DW3000_REG_MASK_ALL(2), DW3000_REG_DIRECT) \
+    X(rx_stamp,         RX_TIME_ID,     RX_TIME_RX_STAMP_OFFSET,  RX_TIME_RX_STAMP_LEN, DW3000_REG_MASK_ALL(5), DW3000_REG_DIRECT) \
+    X(rx_stamp_lo32,    RX_TIME_ID,     RX_TIME_RX_STAMP_OFFSET,  4,  DW3000_REG_MASK_ALL(4), DW3000_REG_DIRECT) \
+    X(rx_rawst,         RX_TIME_ID,     RX_TIME_FP_RAWST_OFFSET,  RX_TIME_RX_STAMP_LEN, DW3000_REG_MASK_ALL(5), DW3000_REG_DIRECT) \
+    X(tx_stamp,         TX_TIME_ID,     TX_TIME_TX_STAMP_OFFSET,  TX_TIME_TX_STAMP_LEN, DW3000_REG_MASK_ALL(5), DW3000_REG_DIRECT) \
+    X(tx_stamp_lo32,    TX_TIME_ID,     TX_TIME_TX_STAMP_OFFSET,  4,  DW3000_REG_MASK_ALL(4), DW3000_REG_DIRECT) \
+    X(tx_rawst,         TX_TIME_ID,     TX_TIME_TX_RAWST_OFFSET,  TX_TIME_TX_STAMP_LEN, DW3000_REG_MASK_ALL(5), DW3000_REG_DIRECT) \
+    X(sys_time,         SYS_TIME_ID,    SYS_TIME_OFFSET,  SYS_TIME_LEN, DW3000_REG_MASK_ALL(5), DW3000_REG_DIRECT) \
+    X(sys_time_lo32,    SYS_TIME_ID,    SYS_TIME_OFFSET,  4,  DW3000_REG_MASK_ALL(4), DW3000_REG_DIRECT) \
+    X(pmsc_state,       SYS_STATE_ID,   PMSC_STATE_OFFSET,  1,  DW3000_REG_MASK_ALL(1), DW3000_REG_DIRECT) \
+    X(dx_time_hi,       DX_TIME_ID,     1,  DX_TIME_LEN-1,  DW3000_REG_MASK_ALL(4), DW3000_REG_DIRECT_WV) \
+    X(rx_fwto,          RX_FWTO_ID,     RX_FWTO_OFFSET,  RX_FWTO_LEN,  RX_FWTO_MASK,  DW3000_REG_DIRECT_WV) \
+    X(tx_fctrl,         TX_FCTRL_ID,    0,  4,  DW3000_REG_MASK_ALL(4), DW3000_REG_DIRECT_WV)
+
+/**
+ * Blocking or non-blocking read with a constant command header,
+ * same crossover as dw3000_read_reg.
+ */
+static inline uint64_t
+dw3000_reg_read_const(dw3000_dev_instance_t * inst, const uint8_t * header, uint8_t len, uint8_t nbytes)
+{
+    union _buffer{
+        uint8_t array[sizeof(uint64_t)];
+        uint64_t value;
+    } __attribute__((__packed__, aligned (8))) buffer = {0};
+
+    if (len+nbytes < inst->spi_rd_max_noblock ||
+        inst->uwb_dev.config.blocking_spi_transfers) {
+        hal_dw3000_read(inst, header, len, buffer.array, nbytes);
+    } else {
+        hal_dw3000_read_noblock(inst, header, len, buffer.array, nbytes);
+    }
+    return buffer.value;
+}
+
+/**
+ * Blocking or non-blocking write with a constant command header,
+ * same crossover as dw3000_write_reg.
+ */
+static inline void
+dw3000_reg_write_const(dw3000_dev_instance_t * inst, const uint8_t * header, uint8_t len, uint64_t val, uint8_t nbytes)
+{
+    union _buffer{
+        uint8_t array[sizeof(uint64_t)];
+        uint64_t value;
+    } __attribute__((__packed__, aligned (8))) buffer = {.value = val};
+
+    if (len+nbytes < inst->spi_rd_max_noblock ||
+        inst->uwb_dev.config.blocking_spi_transfers) {
+        hal_dw3000_write(inst, header, len, buffer.array, nbytes);
+    } else {
+        hal_dw3000_write_noblock(inst, header, len, buffer.array, nbytes);
+        hal_dw3000_rw_noblock_wait(inst, DPL_TIMEOUT_NEVER);
+    }
+}
+
+#define DW3000_REG_ACCESSORS(_NAME, _ID, _OFF, _LEN, _MASK, _DIRECT)                                \
+_Static_assert((_ID) <= 0x3F && (_OFF) + (_LEN) <= 0x7FFF && (_LEN) <= sizeof(uint64_t),            \
+               "register field " #_NAME " out of range");                                           \
+static inline uint64_t                                                                              \
+dw3000_rd_##_NAME(dw3000_dev_instance_t * inst)                                                     \
+{                                                                                                   \
+    static const uint8_t header[] = {DW3000_CMD_HDR(0, _ID, _OFF)};                                 \
+    return dw3000_reg_read_const(inst, header, DW3000_CMD_LEN(_OFF), _LEN);                         \
+}                                                                                                   \
+static inline void                                                                                  \
+dw3000_wr_##_NAME(dw3000_dev_instance_t * inst, uint64_t val)                                       \
+{                                                                                                   \
+    static const uint8_t header[] = {DW3000_CMD_HDR(1, _ID, _OFF)};                                 \
+    if (_DIRECT) {                                                                                  \
+        dw3000_reg_write_const(inst, header, DW3000_CMD_LEN(_OFF), val & (_MASK), _LEN);            \
+    } else {                                                                                        \
+        dw3000_write_reg(inst, _ID, _OFF, val & (_MASK), _LEN);                                     \
+    }                                                                                               \
+}
+
+DW3000_REG_TABLE(DW3000_REG_ACCESSORS)
+
+#undef DW3000_REG_ACCESSORS
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DW3000_REGS_ACCESS_H_ */
@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw3000_rxfilter.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2020
+ * @brief Software frame filter
+ *
+ * @details Rules and compiled programs of the software frame filter. Building and
+ * evaluating a program touches no device state, see dw3000_rx_filter_compile for
+ * the instance api.
+ */
+
+#ifndef _DW3000_RXFILTER_H_
+#define _DW3000_RXFILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <syscfg/syscfg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MYNEWT_VAL(DW3000_RX_FILTER_MAX)
+//! Value tested by an rx filter predicate
+typedef enum _dw3000_rx_filter_src_t{
+    DW3000_RX_FILTER_FRAME,             //!< 1 to 4 frame bytes at offset, little endian
+    DW3000_RX_FILTER_LEN                //!< Frame length without crc
+} dw3000_rx_filter_src_t;
+
+//! Rx filter predicate, holds if min <= (value & mask) <= max
+typedef struct _dw3000_rx_filter_pred_t{
+    uint8_t src;                        //!< dw3000_rx_filter_src_t
+    uint8_t len;                        //!< Number of frame bytes compared, 1 to 4
+    uint16_t offset;                    //!< Offset in the frame of the compared bytes
+    uint32_t mask;                      //!< Bits compared
+    uint32_t min;                       //!< Lowest accepted masked value
+    uint32_t max;                       //!< Highest accepted masked value
+} dw3000_rx_filter_pred_t;
+
+//! Rx filter rule, matches when all its predicates hold, see dw3000_rx_filter_compile
+typedef struct _dw3000_rx_filter_rule_t{
+    const dw3000_rx_filter_pred_t * preds;  //!< Predicates, an empty rule always matches
+    uint8_t npreds;                     //!< Number of predicates
+    uint8_t accept;                     //!< Matching frames are accepted if set, rejected otherwise
+} dw3000_rx_filter_rule_t;
+
+//! Compiled rx filter instruction, one per predicate
+typedef struct _dw3000_rx_filter_insn_t{
+    uint16_t offset;                    //!< Offset of the compared frame bytes
+    uint8_t len;                        //!< Number of frame bytes, 0 for the frame length
+    uint8_t rule;                       //!< Rule the predicate belongs to
+    uint8_t last;                       //!< Last predicate of the rule, 0, or 1 + accept
+    uint8_t fail;                       //!< Next instruction if the predicate does not hold
+    uint32_t mask;                      //!< Bits compared
+    uint32_t min;                       //!< Lowest accepted masked value
+    uint32_t max;                       //!< Highest accepted masked value
+} dw3000_rx_filter_insn_t;
+
+//! Compiled rx filter program
+typedef struct _dw3000_rx_filter_prog_t{
+    dw3000_rx_filter_insn_t insn[MYNEWT_VAL(DW3000_RX_FILTER_MAX)]; //!< Instructions, rules in order
+    uint8_t count;                      //!< Number of instructions
+    uint8_t accept;                     //!< Action when no rule matches
+    uint16_t hdr_len;                   //!< Frame bytes needed to evaluate the program
+    uint32_t hits[MYNEWT_VAL(DW3000_RX_FILTER_RULES)];  //!< Frames matched per rule
+    uint32_t default_hits;              //!< Frames matching no rule
+} dw3000_rx_filter_prog_t;
+
+int dw3000_rx_filter_build(dw3000_rx_filter_prog_t * prog, const dw3000_rx_filter_rule_t * rules, uint8_t nrules, bool accept);
+bool dw3000_rx_filter_eval(dw3000_rx_filter_prog_t * prog, const uint8_t * frame, uint16_t have, uint16_t frame_len);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DW3000_RXFILTER_H_ */
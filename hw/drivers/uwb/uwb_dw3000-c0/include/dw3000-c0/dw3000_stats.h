@@ -49,6 +49,23 @@ STATS_SECT_START(mac_stat_section)
     STATS_SECT_ENTRY(RX_err)
     STATS_SECT_ENTRY(TXBUF_err)
     STATS_SECT_ENTRY(PLL_LL_err)
+    STATS_SECT_ENTRY(SPI_nb_thr)
+    STATS_SECT_ENTRY(SPI_wv_err)
+    STATS_SECT_ENTRY(SPI_wv_retry)
+    STATS_SECT_ENTRY(SPI_wv_fallback)
+    STATS_SECT_ENTRY(SPI_wv_stepup)
+    STATS_SECT_ENTRY(PRF_hop_cnt)
+    STATS_SECT_ENTRY(PRF_hop_usec)
+    STATS_SECT_ENTRY(PRF_hop_max)
+    STATS_SECT_ENTRY(RXR_hwm)
+    STATS_SECT_ENTRY(RXR_drop)
+    STATS_SECT_ENTRY(RXD_hit)
+    STATS_SECT_ENTRY(RXD_miss)
+    STATS_SECT_ENTRY(POLL_enter)
+    STATS_SECT_ENTRY(POLL_drain)
+    STATS_SECT_ENTRY(RXL_skip_bytes)
+    STATS_SECT_ENTRY(RXF_accept)
+    STATS_SECT_ENTRY(RXF_reject)
 STATS_SECT_END
 #endif
 
@@ -35,6 +35,7 @@
 #include <dw3000-c0/dw3000_hal.h>
 #include <dw3000-c0/dw3000_dev.h>
 #include <dw3000-c0/dw3000_regs.h>
+#include <dw3000-c0/dw3000_mac.h>
 #include "dw3000_cli_priv.h"
 
 #if MYNEWT_VAL(DW3000_CLI)
@@ -76,11 +77,8 @@ const struct shell_param cmd_dw3000_param[] = {
     {"status2txt", "<sys_status> to text"},
     {"fctrl2txt", "<fctrl> to text"},
 #endif
-#if MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)
-    {"spibt", "[instance [verbose-num]] spi backtrace"},
-#endif
-#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN) && MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)
-    {"bt", "[instance [verbose-num]] spi+irq backtrace"},
+#if MYNEWT_VAL(DW3000_TRACE_LEN)
+    {"trace", "[instance] dump binary trace, decode with tools/dw3000_trace.py"},
 #endif
     {NULL,NULL},
 };
@@ -93,6 +91,15 @@ const struct shell_cmd_help cmd_dw3000_help = {
 static struct shell_cmd shell_dw3000_cmd =
     SHELL_CMD_EXT("dw3000", dw3000_cli_cmd, &cmd_dw3000_help);
 
+/* Register dumps are diagnostic, read them with the bulk arbitration class */
+static uint64_t
+dw3000_cli_read_reg(struct _dw3000_dev_instance_t * inst, uint16_t reg, size_t nbytes)
+{
+    uint64_t value = 0;
+    dw3000_read_bulk(inst, reg, 0, (uint8_t*)&value, nbytes);
+    return value;
+}
+
 void
 dw3000_cli_dump_registers(struct _dw3000_dev_instance_t * inst, struct streamer *streamer)
 {
@@ -120,7 +127,7 @@ dw3000_cli_dump_registers(struct _dw3000_dev_instance_t * inst, struct streamer
         case (CHAN_CTRL_ID):
         case (TX_ANTD_ID):
         case (RX_FWTO_ID):
-            reg = dw3000_read_reg(inst, i, 0, 4);
+            reg = dw3000_cli_read_reg(inst, i, 4);
             streamer_printf(streamer, "{\"reg[%02X]\"=\"0x%08llX\"}\n",i,reg&0xffffffff);
             break;
         case (SYS_TIME_ID):
@@ -132,12 +139,12 @@ dw3000_cli_dump_registers(struct _dw3000_dev_instance_t * inst, struct streamer
         case (TX_TIME_ID):
         case (SYS_MASK_ID):
         case (SYS_STATE_ID):
-            reg = dw3000_read_reg(inst, i, 0, 5);
+            reg = dw3000_cli_read_reg(inst, i, 5);
             streamer_printf(streamer, "{\"reg[%02X]\"=\"0x%010llX\"}\n",i,reg&0xffffffffffll);
             break;
         default:
             l=8;
-            reg = dw3000_read_reg(inst, i, 0, l);
+            reg = dw3000_cli_read_reg(inst, i, l);
             streamer_printf(streamer, "{\"reg[%02X]\"=\"0x%016llX\"}\n",i,
                            reg&0xffffffffffffffffll);
         }
@@ -168,7 +175,7 @@ dw3000_cli_dump_address(struct _dw3000_dev_instance_t * inst, uint32_t addr, uin
     streamer_printf(streamer, "Dump starting at %06"PRIX32":\n", addr);
     for (i=0;i<length;i+=step) {
         memset(b,0,sizeof(b));
-        dw3000_read(inst, addr, i, b, step);
+        dw3000_read_bulk(inst, addr, i, b, step);
 
         streamer_printf(streamer, "%04X: %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X %02X\n",
                i, b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7],
@@ -369,158 +376,26 @@ dw3000_cli_interrupt_backtrace(struct _dw3000_dev_instance_t * inst, uint16_t ve
 }
 #endif
 
-#if MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)
-static char*
-cmd_to_string(uint8_t *cmd, uint8_t cmd_len)
-{
-    static char b[16];
-    memset(b,0,sizeof(b));
-    char *bp = b;
-    if (cmd[0] & 0x80) bp += snprintf(bp,sizeof(b)-(bp-b), "W");
-    else               bp += snprintf(bp,sizeof(b)-(bp-b), "R");
-    uint8_t cmd_reg  = cmd[0]&0x3F;
-    bp += snprintf(bp,sizeof(b)-(bp-b), "@%02X", cmd_reg);
-    if (cmd_len > 1) {
-        uint8_t cmd_extended = (0x8 & cmd[1]) != 0;
-        uint16_t subaddress = 0x7F & cmd[1];
-        if (cmd_extended && cmd_len > 2) {
-            subaddress |= ((uint16_t)cmd[2]) << 7;
-        }
-        bp += snprintf(bp,sizeof(b)-(bp-b), ":%x", subaddress);
-    }
-
-    return b;
-}
-
-static int
-print_spi_bt_line(uint32_t *start_t, uint16_t verbose,
-                  struct dw3000_spi_backtrace *p,
-                  struct dw3000_spi_backtrace *p_last,
-                  struct streamer *streamer)
-{
-    int j;
-    if (!p->utime) return 0;
-    if (!*start_t) *start_t = p->utime;
-
-    int32_t diff = (p_last)? p->utime-p_last->utime : 0;
-    if (diff < 0) diff = 0;
-    streamer_printf(streamer, " %10lu ", dpl_cputime_ticks_to_usecs(p->utime));
-    streamer_printf(streamer, " %10lu ", dpl_cputime_ticks_to_usecs(p->utime-*start_t));
-    streamer_printf(streamer, " %8lu ", dpl_cputime_ticks_to_usecs(diff));
-    streamer_printf(streamer, " %6lu ", dpl_cputime_ticks_to_usecs(p->utime_end-p->utime));
-    streamer_printf(streamer, " %3s%s  ", (p->non_blocking)?"NB-":"", (p->is_write)?"W":"R");
-
-    streamer_printf(streamer, " ");
-    for (j=0;j<4;j++) {
-        if (j<p->cmd_len) {
-            streamer_printf(streamer, "%02X", p->cmd[j]);
-        } else {
-            streamer_printf(streamer, "  ");
-        }
-    }
-
-    if (verbose&0x1) {
-        char *s = cmd_to_string(p->cmd, p->cmd_len);
-        streamer_printf(streamer, " (%s)%*s", s, 17-strlen(s), " ");
-    }
-    streamer_printf(streamer, " %4d ", p->data_len);
-    for (j=0;j<p->data_len&&j<sizeof(p->data);j++) {
-        streamer_printf(streamer, "%02X", p->data[j]);
-    }
-    return 1;
-}
-
-void
-dw3000_cli_spi_backtrace(struct _dw3000_dev_instance_t * inst, uint16_t verbose,
-                         struct streamer *streamer)
-{
-    int i;
-    uint32_t start_t = 0;
-    struct dw3000_spi_backtrace *p, *p_last=0;
-
-    streamer_printf(streamer, " %10s ", "abs");
-    streamer_printf(streamer, " %10s ", "usec");
-    streamer_printf(streamer, " %8s ", "diff");
-    streamer_printf(streamer, " %6s ", "dur");
-    streamer_printf(streamer, " %5s", "flags");
-    streamer_printf(streamer, " %s      ", "cmd");
-    if (verbose&0x1) {
-        streamer_printf(streamer, "(cmd2txt)%21s ", "");
-    }
-    streamer_printf(streamer, " %4s ", "dlen");
-    streamer_printf(streamer, " %s\n", "data");
-    for (i=0;i<80;i++) streamer_printf(streamer, "-");
-    if (verbose&0x1) {
-        for (i=0;i<34;i++) streamer_printf(streamer, "-");
-    }
-    streamer_printf(streamer, "\n");
-
-    inst->spi_bt_lock = 1;
-    for (i=0;i<MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN);i++) {
-        uint16_t i_mod = (inst->spi_bt_idx + i + 1) % MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN);
-        p = &inst->spi_bt[i_mod];
-        if (print_spi_bt_line(&start_t, verbose, p, p_last, streamer)) {
-            streamer_printf(streamer, "\n");
-        }
-        p_last = p;
-    }
-    inst->spi_bt_lock = 0;
-}
-#endif
-
-#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN) && MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)
-
+#if MYNEWT_VAL(DW3000_TRACE_LEN)
+/* Raw dump of the trace ring, oldest record first. Records that are
+ * being written while dumping may be torn. */
 void
-dw3000_cli_backtrace(struct _dw3000_dev_instance_t * inst, uint16_t verbose, struct streamer *streamer)
+dw3000_cli_trace(struct _dw3000_dev_instance_t * inst, struct streamer *streamer)
 {
-    int i;
-    uint16_t spi_i=0, irq_i=0;
-    uint32_t start_t = 0;
-    struct dw3000_spi_backtrace *spi_p, *spi_p_last=0;
-    struct dw3000_sys_status_backtrace *irq_p, *irq_p_last=0;
-
-    streamer_printf(streamer, " %10s ", "abs");
-    streamer_printf(streamer, " %10s ", "usec");
-    streamer_printf(streamer, " %8s ", "diff");
-    streamer_printf(streamer, " %6s ", "dur");
-    streamer_printf(streamer, " %5s", "flags");
-    streamer_printf(streamer, " cmd/status data\n");
-    for (i=0;i<80;i++) streamer_printf(streamer, "-");
-    if (verbose&0x1) {
-        for (i=0;i<34;i++) streamer_printf(streamer, "-");
-    }
-    streamer_printf(streamer, "\n");
-
-
-    inst->spi_bt_lock = 1;
-    inst->sys_status_bt_lock = 1;
-    while (spi_i<MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN) || irq_i<MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)) {
-        uint16_t spi_i_mod = (inst->spi_bt_idx + spi_i + 1) % MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN);
-        uint16_t irq_i_mod = (inst->sys_status_bt_idx + irq_i + 1) % MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN);
-        spi_p = &inst->spi_bt[spi_i_mod];
-        irq_p = &inst->sys_status_bt[irq_i_mod];
-        if ((spi_p->utime < irq_p->utime && spi_i < MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)) ||
-            irq_i >= MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)) {
-            if (print_spi_bt_line(&start_t, verbose, spi_p, spi_p_last, streamer)) {
-                streamer_printf(streamer, "\n");
-            }
-            spi_p_last = spi_p;
-            spi_i++;
-        } else {
-            streamer_printf(streamer, "\e[93m");   /* Set to bright yellow */
-            if (print_interrupt_bt_line(&start_t, verbose, irq_p, irq_p_last, streamer)) {
-                streamer_printf(streamer, "\e[39m\n");   /* Set to default colour */
-            } else {
-                streamer_printf(streamer, "\e[39m");     /* Set to default colour */
-            }
-            irq_p_last = irq_p;
-            irq_i++;
+    uint32_t i, idx = inst->trace_idx;
+    uint32_t first = (idx > MYNEWT_VAL(DW3000_TRACE_LEN)) ? idx - MYNEWT_VAL(DW3000_TRACE_LEN) : 0;
+
+    streamer_printf(streamer, "{\"trace\":%d,\"idx\":%lu,\"usec_per_64k_ticks\":%lu}\n",
+                    inst->uwb_dev.idx, (unsigned long)idx,
+                    (unsigned long)dpl_cputime_ticks_to_usecs(0x10000));
+    for (i = first;i < idx;i++) {
+        const uint8_t *p = (const uint8_t*)&inst->trace[i & (MYNEWT_VAL(DW3000_TRACE_LEN) - 1)];
+        for (int j = 0;j < sizeof(struct dw3000_trace_rec);j++) {
+            streamer_printf(streamer, "%02X", p[j]);
         }
+        streamer_printf(streamer, "\n");
     }
-    inst->spi_bt_lock = 0;
-    inst->sys_status_bt_lock = 0;
 }
-
 #endif
 
 #ifndef __KERNEL__
@@ -591,9 +466,9 @@ dw3000_cli_cmd(const struct shell_cmd *cmd, int argc, char **argv, struct stream
         }
         inst_n = strtol(argv[2], NULL, 0);
         inst = hal_dw3000_inst(inst_n);
-        hal_gpio_irq_disable(inst->irq_pin);
+        dw3000_irq_disable(inst);
         dw3000_write_reg(inst, SYS_MASK_ID, 0, 0, sizeof(uint32_t));
-        dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, SYS_CTRL_TRXOFF, sizeof(uint8_t));
+        dw3000_fast_cmd(inst, DW3000_FCMD_TRXOFF);
         dw3000_configcwmode(inst, inst->uwb_dev.config.channel);
         streamer_printf(streamer, "Device[%d] now in CW mode on ch %d. Reset to continue\n",
                         inst_n, inst->uwb_dev.config.channel);
@@ -650,40 +525,16 @@ dw3000_cli_cmd(const struct shell_cmd *cmd, int argc, char **argv, struct stream
         streamer_printf(streamer, "----\n ledgend: \n");
         fctrl_ledgend(streamer);
 #endif
-#if MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)
-    } else if (!strcmp(argv[1], "spibt")){
-        uint8_t d=0;
+#if MYNEWT_VAL(DW3000_TRACE_LEN)
+    } else if (!strcmp(argv[1], "trace")){
         if (argc < 3) {
             inst_n=0;
         } else {
             inst_n = strtol(argv[2], NULL, 0);
         }
-        if (argc < 4) {
-            d=0;
-        } else {
-            d = strtol(argv[3], NULL, 0);
-        }
-        inst = hal_dw3000_inst(inst_n);
-        console_no_ticks();
-        dw3000_cli_spi_backtrace(inst, d, streamer);
-        console_yes_ticks();
-#endif
-#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN) && MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)
-    } else if (!strcmp(argv[1], "bt")){
-        uint8_t d=0;
-        if (argc < 3) {
-            inst_n=0;
-        } else {
-            inst_n = strtol(argv[2], NULL, 0);
-        }
-        if (argc < 4) {
-            d=0;
-        } else {
-            d = strtol(argv[3], NULL, 0);
-        }
         inst = hal_dw3000_inst(inst_n);
         console_no_ticks();
-        dw3000_cli_backtrace(inst, d, streamer);
+        dw3000_cli_trace(inst, streamer);
         console_yes_ticks();
 #endif
     } else {
@@ -100,11 +100,6 @@ static int cmd_dump(struct seq_file *s, void *data)
         dw3000_cli_interrupt_backtrace(inst, 1, &streamer_debugfs);
     }
 #endif
-#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN) && MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN)
-    if (!strcmp(cmd->fn, "bt")) {
-        dw3000_cli_backtrace(inst, 1, &streamer_debugfs);
-    }
-#endif
 
     seq_file = 0;
 	return 0;
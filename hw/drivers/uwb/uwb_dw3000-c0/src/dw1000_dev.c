@@ -28,6 +28,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <dpl/dpl.h>
 #include <dpl/dpl_cputime.h>
@@ -53,6 +54,383 @@ typedef struct _dw3000_cmd{
     uint32_t subaddress:15;  //!< Indicates subaddress of register
 } dw3000_cmd_t;
 
+#if MYNEWT_VAL(DW3000_REG_SHADOW)
+//! Location of the registers mirrored in the shadow cache
+static const struct dw3000_shadow_reg {
+    uint8_t reg;        //!< Register file
+    uint16_t offset;    //!< Subaddress within register file
+    uint8_t len;        //!< Length in bytes
+    uint8_t masked;     //!< Upper nibble of each byte written is a write enable mask for the lower nibble
+} dw3000_shadow_regs[DW3000_SHADOW_NUM] = {
+    [DW3000_SHADOW_SYS_CFG]    = {SYS_CFG_ID, 0, SYS_CFG_LEN, 0},
+    [DW3000_SHADOW_SYS_MASK]   = {SYS_MASK_ID, 0, SYS_MASK_LEN, 0},
+    [DW3000_SHADOW_PMSC_CTRL1] = {PMSC_ID, PMSC_CTRL1_OFFSET, PMSC_CTRL1_LEN, 0},
+    [DW3000_SHADOW_AON_WCFG]   = {AON_ID, AON_WCFG_OFFSET, AON_WCFG_LEN, 0},
+    [DW3000_SHADOW_AON_CFG0]   = {AON_ID, AON_CFG0_OFFSET, AON_CFG0_LEN, 0},
+    [DW3000_SHADOW_GPIO_MODE]  = {GPIO_CTRL_ID, GPIO_MODE_OFFSET, GPIO_MODE_LEN, 0},
+    [DW3000_SHADOW_GPIO_DIR]   = {GPIO_CTRL_ID, GPIO_DIR_OFFSET, GPIO_DIR_LEN, 1},
+    [DW3000_SHADOW_LDE_REPC]   = {LDE_IF_ID, LDE_REPC_OFFSET, sizeof(uint16_t), 0},
+    [DW3000_SHADOW_FS_PLLCFG]  = {FS_CTRL_ID, FS_PLLCFG_OFFSET, sizeof(uint32_t), 0},
+    [DW3000_SHADOW_FS_PLLTUNE] = {FS_CTRL_ID, FS_PLLTUNE_OFFSET, sizeof(uint8_t), 0},
+    [DW3000_SHADOW_RF_RXCTRLH] = {RF_CONF_ID, RF_RXCTRLH_OFFSET, sizeof(uint8_t), 0},
+    [DW3000_SHADOW_RF_TXCTRL]  = {RF_CONF_ID, RF_TXCTRL_OFFSET, RF_TXCTRL_LEN, 0},
+    [DW3000_SHADOW_DRX_TUNE0b] = {DRX_CONF_ID, DRX_TUNE0b_OFFSET, sizeof(uint16_t), 0},
+    [DW3000_SHADOW_DRX_TUNE1a] = {DRX_CONF_ID, DRX_TUNE1a_OFFSET, sizeof(uint16_t), 0},
+    [DW3000_SHADOW_DRX_TUNE1b] = {DRX_CONF_ID, DRX_TUNE1b_OFFSET, sizeof(uint16_t), 0},
+    [DW3000_SHADOW_DRX_TUNE2]  = {DRX_CONF_ID, DRX_TUNE2_OFFSET, DRX_TUNE2_LEN, 0},
+    [DW3000_SHADOW_DRX_TUNE4H] = {DRX_CONF_ID, DRX_TUNE4H_OFFSET, sizeof(uint16_t), 0},
+    [DW3000_SHADOW_DRX_SFDTOC] = {DRX_CONF_ID, DRX_SFDTOC_OFFSET, sizeof(uint16_t), 0},
+    [DW3000_SHADOW_AGC_TUNE1]  = {AGC_CTRL_ID, AGC_TUNE1_OFFSET, sizeof(uint16_t), 0},
+    [DW3000_SHADOW_AGC_TUNE2]  = {AGC_CTRL_ID, AGC_TUNE2_OFFSET, AGC_TUNE2_LEN, 0},
+    [DW3000_SHADOW_USR_SFD]    = {USR_SFD_ID, 0, sizeof(uint8_t), 0},
+    [DW3000_SHADOW_CHAN_CTRL]  = {CHAN_CTRL_ID, 0, CHAN_CTRL_LEN, 0},
+};
+
+/**
+ * Keep the register shadow coherent with data being written to the device.
+ * A write covering a whole register validates its shadow, partial writes
+ * only update an already valid shadow.
+ *
+ * @param inst          Pointer to dw3000_dev_instance_t.
+ * @param reg           Register file being written.
+ * @param subaddress    Address where writing of data begins.
+ * @param buffer        Data being written.
+ * @param length        Length of data.
+ * @return void
+ */
+static void
+dw3000_shadow_update(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, const uint8_t * buffer, uint16_t length)
+{
+    for (int i = 0;i < DW3000_SHADOW_NUM;i++) {
+        const struct dw3000_shadow_reg * r = &dw3000_shadow_regs[i];
+        uint16_t start, end;
+
+        if (r->reg != reg || subaddress >= r->offset + r->len || subaddress + length <= r->offset) {
+            continue;
+        }
+        start = (subaddress > r->offset) ? subaddress : r->offset;
+        end = (subaddress + length < r->offset + r->len) ? subaddress + length : r->offset + r->len;
+
+        if (r->masked) {
+            if (!(inst->shadow_valid & (1UL << i))) {
+                continue;
+            }
+            for (uint16_t a = start;a < end;a++) {
+                uint8_t v = buffer[a - subaddress];
+                uint8_t * p = &inst->shadow[i][a - r->offset];
+                *p = ((*p & ~(v >> 4)) | (v & (v >> 4))) & 0x0F;
+            }
+        } else if (start == r->offset && end == r->offset + r->len) {
+            memcpy(inst->shadow[i], buffer + (start - subaddress), r->len);
+            inst->shadow_valid |= (1UL << i);
+        } else if (inst->shadow_valid & (1UL << i)) {
+            memcpy(&inst->shadow[i][start - r->offset], buffer + (start - subaddress), end - start);
+        }
+    }
+}
+#else
+#define dw3000_shadow_update(_I, _R, _S, _B, _L) {}
+#endif
+
+#if MYNEWT_VAL(DW3000_SPI_WRITE_VERIFY)
+//! Register files whose writes are verified
+static const uint64_t dw3000_spi_wv_regs =
+    (1ULL << SYS_CFG_ID) | (1ULL << SYS_MASK_ID) | (1ULL << PANADR_ID) |
+    (1ULL << EUI_64_ID) | (1ULL << TX_FCTRL_ID) | (1ULL << DX_TIME_ID) |
+    (1ULL << RX_FWTO_ID) | (1ULL << ACK_RESP_T_ID) | (1ULL << TX_POWER_ID) |
+    (1ULL << CHAN_CTRL_ID);
+
+//! Bits compared on readback, for register files with read only or reserved bits
+static const struct {
+    uint8_t reg;
+    uint64_t mask;
+} dw3000_spi_wv_masks[] = {
+    {SYS_CFG_ID,    SYS_CFG_MASK},
+    {SYS_MASK_ID,   SYS_MASK_MASK_32},
+    {TX_FCTRL_ID,   TX_FCTRL_SAFE_MASK_32 | TX_FCTRL_IFSDELAY_MASK},
+    {RX_FWTO_ID,    RX_FWTO_MASK},
+    {ACK_RESP_T_ID, ACK_RESP_T_MASK},
+    {CHAN_CTRL_ID,  CHAN_CTRL_MASK},
+};
+
+#define dw3000_spi_wv_protected(_R, _L) (((dw3000_spi_wv_regs >> (_R)) & 1) && (_L) <= sizeof(uint64_t))
+
+#if MYNEWT_VAL(DW3000_MAC_STATS)
+#define SPI_WV_STATS_INC(__X) STATS_INC(inst->stat, __X)
+#else
+#define SPI_WV_STATS_INC(__X) {}
+#endif
+
+/**
+ * Measure the non-blocking crossover again after the write verification changed
+ * the baudrate. Runs from the event queue of the instance, the measurement
+ * takes some 80 reads which don't belong in the write path.
+ *
+ * @param ev    Pointer to the dpl_event, argument is the instance.
+ * @return void
+ */
+static void
+dw3000_spi_tune_ev_cb(struct dpl_event * ev)
+{
+    dw3000_dev_instance_t * inst = (dw3000_dev_instance_t *)dpl_event_get_arg(ev);
+
+    dw3000_spi_tune_noblock(inst);
+#if MYNEWT_VAL(DW3000_MAC_STATS)
+    STATS_SET(inst->stat, SPI_nb_thr, inst->spi_rd_max_noblock);
+#endif
+}
+
+/**
+ * Set the full speed spi baudrate after a step down or up. The bus is
+ * reconfigured with the next transfer, the non-blocking crossover is measured
+ * again from the event queue. Without a running event queue it's measured by
+ * the next dw3000_dev_config.
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param baudrate  New full speed baudrate.
+ * @return void
+ */
+static void
+dw3000_spi_wv_set_baudrate(dw3000_dev_instance_t * inst, int baudrate)
+{
+    inst->spi_baudrate = baudrate;
+    inst->spi_wv_good = 0;
+    if (dpl_eventq_inited(&inst->uwb_dev.eventq)) {
+        dpl_eventq_put(&inst->uwb_dev.eventq, &inst->spi_tune_ev);
+    }
+}
+
+/**
+ * Recovery policy of the spi write verification. After DW3000_SPI_WRITE_VERIFY_FALLBACK
+ * consecutive mismatches the baudrate is halved, down to spi_baudrate_low.
+ * After DW3000_SPI_WRITE_VERIFY_STEPUP consecutive good writes at a reduced baudrate
+ * it's doubled again, up to the configured baudrate.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param good  Outcome of the last check.
+ * @return void
+ */
+static void
+dw3000_spi_wv_account(dw3000_dev_instance_t * inst, bool good)
+{
+    int baudrate;
+
+    if (good) {
+        inst->spi_wv_errs = 0;
+#if MYNEWT_VAL(DW3000_SPI_WRITE_VERIFY_STEPUP)
+        if (inst->spi_baudrate < inst->spi_baudrate_max &&
+            ++inst->spi_wv_good >= MYNEWT_VAL(DW3000_SPI_WRITE_VERIFY_STEPUP)) {
+            baudrate = inst->spi_baudrate * 2;
+            if (baudrate > inst->spi_baudrate_max) {
+                baudrate = inst->spi_baudrate_max;
+            }
+            SPI_WV_STATS_INC(SPI_wv_stepup);
+            dw3000_spi_wv_set_baudrate(inst, baudrate);
+        }
+#endif
+        return;
+    }
+
+    SPI_WV_STATS_INC(SPI_wv_err);
+    inst->spi_wv_good = 0;
+    if (++inst->spi_wv_errs < MYNEWT_VAL(DW3000_SPI_WRITE_VERIFY_FALLBACK)) {
+        return;
+    }
+    inst->spi_wv_errs = 0;
+    if (inst->spi_baudrate <= inst->spi_baudrate_low) {
+        return;
+    }
+    baudrate = inst->spi_baudrate / 2;
+    if (baudrate < inst->spi_baudrate_low) {
+        baudrate = inst->spi_baudrate_low;
+    }
+    SPI_WV_STATS_INC(SPI_wv_fallback);
+    dw3000_spi_wv_set_baudrate(inst, baudrate);
+}
+
+/**
+ * Write a register and read it back within one bus acquisition, so no other
+ * bus user can change it in between, then compare the bits that read back as
+ * written, see dw3000_spi_wv_masks. A mismatching write is repeated up to
+ * DW3000_SPI_WRITE_VERIFY_RETRIES times.
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param header    Command header of the write.
+ * @param len       Length of header.
+ * @param buffer    Data to write.
+ * @param length    Length of data, at most 8 bytes.
+ * @return DPL_OK if the register holds the data written, DPL_ERROR otherwise
+ */
+static int
+dw3000_spi_wv_write(dw3000_dev_instance_t * inst, const uint8_t * header, uint8_t len, uint8_t * buffer, uint16_t length)
+{
+    dw3000_spi_xfer_t xfers[2];
+    uint8_t reg = header[0] & 0x3F;
+    uint16_t sub = (len > 1) ? ((header[1] & 0x7F) | ((len > 2) ? header[2] << 7 : 0)) : 0;
+    uint64_t mask = UINT64_MAX;
+    int retries = MYNEWT_VAL(DW3000_SPI_WRITE_VERIFY_RETRIES);
+
+    for (int i = 0;i < sizeof(dw3000_spi_wv_masks)/sizeof(dw3000_spi_wv_masks[0]);i++) {
+        if (dw3000_spi_wv_masks[i].reg == reg) {
+            mask = (sub < sizeof(uint64_t)) ? dw3000_spi_wv_masks[i].mask >> (8 * sub) : 0;
+            break;
+        }
+    }
+
+    memcpy(xfers[0].cmd, header, len);
+    xfers[0].cmd_size = len;
+    xfers[0].is_write = 1;
+    xfers[0].length = length;
+    xfers[0].buffer = buffer;
+    xfers[1] = xfers[0];
+    xfers[1].cmd[0] &= ~0x80;  // Same address, read operation
+    xfers[1].is_write = 0;
+    xfers[1].buffer = xfers[1].data;
+
+    while (1) {
+        bool good = true;
+        if (hal_dw3000_batch(inst, xfers, 2) != DPL_OK) {
+            inst->uwb_dev.status.spi_error = 1;
+            return DPL_ERROR;
+        }
+        for (int i = 0;i < length;i++) {
+            if ((xfers[1].data[i] ^ buffer[i]) & (uint8_t)(mask >> (8 * i))) {
+                good = false;
+                break;
+            }
+        }
+        dw3000_spi_wv_account(inst, good);
+        if (good) {
+            return DPL_OK;
+        }
+        if (retries-- == 0) {
+            inst->uwb_dev.status.spi_w_error = 1;
+            return DPL_ERROR;
+        }
+        SPI_WV_STATS_INC(SPI_wv_retry);
+    }
+}
+#endif
+
+#if MYNEWT_VAL(DW3000_SPI_WC_MAX)
+//! Register files where a write triggers the hardware or depends on its ordering, never combined
+static const uint64_t dw3000_wc_nocombine =
+    (1ULL << TX_BUFFER_ID) | (1ULL << SYS_CTRL_ID) | (1ULL << SYS_STATUS_ID) |
+    (1ULL << GPIO_CTRL_ID) | (1ULL << OTP_IF_ID) | (1ULL << AON_ID) |
+    (1ULL << TX_CAL_ID) | (1ULL << PMSC_ID);
+
+/**
+ * Add a write to the pending combined burst. A write extending or overlapping
+ * the pending burst in the same register file is merged into it, later data
+ * replacing earlier data. Any other write flushes the pending burst first, so
+ * the order of writes to different register files is kept. Only writes from
+ * the task which called dw3000_wc_begin are held back; writes from any other
+ * task, the interrupt task included, acquire the bus and so flush the pending
+ * burst before they go out. The burst is only changed with the bus held, so a
+ * flush by another task never sends a half updated burst.
+ *
+ * @param inst          Pointer to dw3000_dev_instance_t.
+ * @param reg           Register file being written.
+ * @param subaddress    Address where writing of data begins.
+ * @param buffer        Data being written.
+ * @param length        Length of data.
+ * @return 1 if the write has been taken, 0 if it has to be written now
+ */
+static int
+dw3000_wc_add(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, const uint8_t * buffer, uint16_t length)
+{
+    int rc;
+    uint16_t start, end;
+
+    if (!inst->wc_active || inst->wc_task != dpl_get_current_task_id()) {
+        return 0;
+    }
+    if (((dw3000_wc_nocombine >> reg) & 1) || length > MYNEWT_VAL(DW3000_SPI_WC_MAX)
+#if MYNEWT_VAL(DW3000_SPI_WRITE_VERIFY)
+        || dw3000_spi_wv_protected(reg, length)
+#endif
+        ) {
+        /* Acquiring the bus for this write flushes the pending burst */
+        return 0;
+    }
+
+    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    if (rc != DPL_OK) {
+        inst->uwb_dev.status.sem_error = 1;
+        return 0;
+    }
+    if (inst->wc_len && reg == inst->wc_reg &&
+        subaddress <= inst->wc_sub + inst->wc_len && subaddress + length >= inst->wc_sub) {
+        start = (subaddress < inst->wc_sub) ? subaddress : inst->wc_sub;
+        end = (subaddress + length > inst->wc_sub + inst->wc_len) ? subaddress + length : inst->wc_sub + inst->wc_len;
+        if (end - start <= MYNEWT_VAL(DW3000_SPI_WC_MAX)) {
+            if (start < inst->wc_sub) {
+                memmove(inst->wc_buf + (inst->wc_sub - start), inst->wc_buf, inst->wc_len);
+            }
+            memcpy(inst->wc_buf + (subaddress - start), buffer, length);
+            inst->wc_sub = start;
+            inst->wc_len = end - start;
+            rc = dpl_sem_release(inst->spi_sem);
+            assert(rc == DPL_OK);
+            return 1;
+        }
+    }
+    rc = dpl_sem_release(inst->spi_sem);
+    assert(rc == DPL_OK);
+
+    /* Only this task starts a burst, it stays empty once flushed */
+    hal_dw3000_wc_flush(inst);
+    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    if (rc != DPL_OK) {
+        inst->uwb_dev.status.sem_error = 1;
+        return 0;
+    }
+    inst->wc_reg = reg;
+    inst->wc_sub = subaddress;
+    inst->wc_len = length;
+    memcpy(inst->wc_buf, buffer, length);
+    rc = dpl_sem_release(inst->spi_sem);
+    assert(rc == DPL_OK);
+    return 1;
+}
+#else
+#define dw3000_wc_add(_I, _R, _S, _B, _L) (0)
+#endif
+
+/**
+ * API to start combining writes. Until dw3000_wc_end contiguous or
+ * overlapping writes to the same register file are merged into a single
+ * spi burst, see DW3000_SPI_WC_MAX. Reads and any other transfer write
+ * out the pending burst first. Combining is limited to the calling task.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_wc_begin(dw3000_dev_instance_t * inst)
+{
+#if MYNEWT_VAL(DW3000_SPI_WC_MAX)
+    inst->wc_task = dpl_get_current_task_id();
+    inst->wc_active = 1;
+#endif
+}
+
+/**
+ * API to stop combining writes and write out the pending burst. A failed
+ * write of a combined burst sets status.spi_error.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_wc_end(dw3000_dev_instance_t * inst)
+{
+#if MYNEWT_VAL(DW3000_SPI_WC_MAX)
+    inst->wc_active = 0;
+    hal_dw3000_wc_flush(inst);
+#endif
+}
+
 /**
  * API to perform dw3000_read from given address.
  *
@@ -89,7 +467,7 @@ dw3000_read(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uin
     /* Possible issue here when reading shorter amounts of data
      * using the nonblocking read with double buffer. Asserts on
      * mutex releases seen in calling function when reading frames of length 8 */
-    if (length < MYNEWT_VAL(DW3000_DEVICE_SPI_RD_MAX_NOBLOCK) ||
+    if (len+length < inst->spi_rd_max_noblock ||
         inst->uwb_dev.config.blocking_spi_transfers) {
         hal_dw3000_read(inst, header, len, buffer, length);
     } else {
@@ -99,6 +477,59 @@ dw3000_read(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uin
     return inst->uwb_dev.status;
 }
 
+/**
+ * API to perform a bulk or diagnostic read from given address. The read is
+ * split in transactions of at most DW3000_SPI_BULK_CHUNK bytes, each acquiring
+ * the bus with the bulk arbitration class, so that more urgent transfers on
+ * the same bus are not held up for the whole read. Chunks take the same
+ * blocking or nonblocking (DMA) path dw3000_read would.
+ *
+ * @param inst          Pointer to dw3000_dev_instance_t.
+ * @param reg           Member of dw3000_cmd_t structure.
+ * @param subaddress    Member of dw3000_cmd_t structure.
+ * @param buffer        Result is stored in buffer.
+ * @param length        Represents buffer length.
+ * @return struct uwb_dev_status
+ */
+struct uwb_dev_status
+dw3000_read_bulk(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length)
+{
+    assert(reg <= 0x3F); // Record number is limited to 6-bits.
+    assert((subaddress <= 0x7FFF) && ((subaddress + length) <= 0x7FFF)); // Index and sub-addressable area are limited to 15-bits.
+
+    for (uint16_t offset = 0;offset < length;offset += MYNEWT_VAL(DW3000_SPI_BULK_CHUNK)) {
+        uint16_t sub = subaddress + offset;
+        uint16_t chunk = (length - offset > MYNEWT_VAL(DW3000_SPI_BULK_CHUNK)) ?
+            MYNEWT_VAL(DW3000_SPI_BULK_CHUNK) : length - offset;
+        dw3000_cmd_t cmd = {
+            .reg = reg,
+            .subindex = sub != 0,
+            .operation = 0, //Read
+            .extended = sub > 0x7F,
+            .subaddress = sub
+        };
+        uint8_t header[] = {
+            [0] = cmd.operation << 7 | cmd.subindex << 6 | cmd.reg,
+            [1] = cmd.extended << 7 | (uint8_t) (sub),
+            [2] = (uint8_t) (sub >> 7)
+        };
+        uint8_t len = cmd.subaddress?(cmd.extended?3:2):1;
+
+        int rc;
+
+        if (len+chunk < inst->spi_rd_max_noblock ||
+            inst->uwb_dev.config.blocking_spi_transfers) {
+            rc = hal_dw3000_read_prio(inst, DW3000_SPI_PRIO_BULK, header, len, buffer + offset, chunk);
+        } else {
+            rc = hal_dw3000_read_noblock_prio(inst, DW3000_SPI_PRIO_BULK, header, len, buffer + offset, chunk);
+        }
+        if (rc != DPL_OK) {
+            break;
+        }
+    }
+    return inst->uwb_dev.status;
+}
+
 /**
  * API to performs dw3000_write into given address.
  *
@@ -132,8 +563,20 @@ dw3000_write(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, ui
     assert(reg <= 0x3F); // Record number is limited to 6-bits.
     assert((subaddress <= 0x7FFF) && ((subaddress + length) <= 0x7FFF)); // Index and sub-addressable area are limited to 15-bits.
 
+    dw3000_shadow_update(inst, reg, subaddress, buffer, length);
+    if (dw3000_wc_add(inst, reg, subaddress, buffer, length)) {
+        return inst->uwb_dev.status;
+    }
+
+#if MYNEWT_VAL(DW3000_SPI_WRITE_VERIFY)
+    if (dw3000_spi_wv_protected(reg, length)) {
+        dw3000_spi_wv_write(inst, header, len, buffer, length);
+        return inst->uwb_dev.status;
+    }
+#endif
+
     /* Only use non-blocking write if the length of the write justifies it */
-    if (len+length < MYNEWT_VAL(DW3000_DEVICE_SPI_RD_MAX_NOBLOCK) ||
+    if (len+length < inst->spi_rd_max_noblock ||
         inst->uwb_dev.config.blocking_spi_transfers) {
         hal_dw3000_write(inst, header, len, buffer, length);
     } else {
@@ -180,7 +623,7 @@ dw3000_read_reg(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress,
     assert((subaddress <= 0x7FFF) && ((subaddress + nbytes) <= 0x7FFF)); // Index and sub-addressable area are limited to 15-bits.
     assert(nbytes <= sizeof(uint64_t));
 
-    if (len+nbytes < MYNEWT_VAL(DW3000_DEVICE_SPI_RD_MAX_NOBLOCK) ||
+    if (len+nbytes < inst->spi_rd_max_noblock ||
         inst->uwb_dev.config.blocking_spi_transfers) {
         hal_dw3000_read(inst, header, len, buffer.array, nbytes);
     } else {
@@ -229,7 +672,19 @@ dw3000_write_reg(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress
     assert(reg <= 0x3F); // Record number is limited to 6-bits.
     assert((subaddress <= 0x7FFF) && ((subaddress + nbytes) <= 0x7FFF)); // Index and sub-addressable area are limited to 15-bits.
 
-    if (len+nbytes < MYNEWT_VAL(DW3000_DEVICE_SPI_RD_MAX_NOBLOCK) ||
+    dw3000_shadow_update(inst, reg, subaddress, buffer.array, nbytes);
+    if (dw3000_wc_add(inst, reg, subaddress, buffer.array, nbytes)) {
+        return;
+    }
+
+#if MYNEWT_VAL(DW3000_SPI_WRITE_VERIFY)
+    if (dw3000_spi_wv_protected(reg, nbytes)) {
+        dw3000_spi_wv_write(inst, header, len, buffer.array, nbytes);
+        return;
+    }
+#endif
+
+    if (len+nbytes < inst->spi_rd_max_noblock ||
         inst->uwb_dev.config.blocking_spi_transfers) {
         hal_dw3000_write(inst, header, len, buffer.array, nbytes);
     } else {
@@ -238,6 +693,576 @@ dw3000_write_reg(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress
     }
 }
 
+//! Write header of SYS_CTRL byte n
+#define SYS_CTRL_WR(_N) (((_N) ? 0xC0 : 0x80) | SYS_CTRL_ID)
+
+/*! Precomputed spi sequences of the fast commands, header and data in a single
+ * transfer. The first byte is the length of the sequence. */
+static const uint8_t dw3000_fast_cmds[DW3000_FCMD_NUM][4] = {
+    [DW3000_FCMD_TX]         = {2, SYS_CTRL_WR(0), SYS_CTRL_TXSTRT},
+    [DW3000_FCMD_TX_DLY]     = {2, SYS_CTRL_WR(0), SYS_CTRL_TXSTRT | SYS_CTRL_TXDLYS},
+    [DW3000_FCMD_TX_W4R]     = {2, SYS_CTRL_WR(0), SYS_CTRL_TXSTRT | SYS_CTRL_WAIT4RESP},
+    [DW3000_FCMD_TX_DLY_W4R] = {2, SYS_CTRL_WR(0), SYS_CTRL_TXSTRT | SYS_CTRL_TXDLYS | SYS_CTRL_WAIT4RESP},
+    [DW3000_FCMD_RX]         = {3, SYS_CTRL_WR(1), 1, SYS_CTRL_RXENAB >> 8},
+    [DW3000_FCMD_RX_DLY]     = {3, SYS_CTRL_WR(1), 1, (SYS_CTRL_RXENAB | SYS_CTRL_RXDLYE) >> 8},
+    [DW3000_FCMD_RX_W4R]     = {3, SYS_CTRL_WR(0), SYS_CTRL_WAIT4RESP, SYS_CTRL_RXENAB >> 8},
+    [DW3000_FCMD_RX_DLY_W4R] = {3, SYS_CTRL_WR(0), SYS_CTRL_WAIT4RESP, (SYS_CTRL_RXENAB | SYS_CTRL_RXDLYE) >> 8},
+    [DW3000_FCMD_TRXOFF]     = {2, SYS_CTRL_WR(0), SYS_CTRL_TRXOFF},
+    [DW3000_FCMD_TX_TRXOFF]  = {2, SYS_CTRL_WR(0), SYS_CTRL_TXSTRT | SYS_CTRL_TRXOFF},
+    [DW3000_FCMD_HRBT]       = {3, SYS_CTRL_WR(1), SYS_CTRL_HRBT_OFFSET, SYS_CTRL_HRBT >> 24},
+};
+
+/**
+ * API to issue a radio control fast command. The command is sent as a
+ * precomputed sequence in a single blocking transfer, without building a
+ * header or splitting command and data.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param cmd   Fast command, see dw3000_fast_cmd_t.
+ * @return struct uwb_dev_status
+ */
+struct uwb_dev_status
+dw3000_fast_cmd(dw3000_dev_instance_t * inst, dw3000_fast_cmd_t cmd)
+{
+    const uint8_t * seq;
+
+    assert(cmd < DW3000_FCMD_NUM);
+    seq = dw3000_fast_cmds[cmd];
+    hal_dw3000_write(inst, &seq[1], seq[0], NULL, 0);
+    return inst->uwb_dev.status;
+}
+
+/**
+ * API to read a register through the shadow cache. Registers mirrored in the
+ * shadow are only read over spi the first time after an invalidation, all
+ * other registers are read from the device.
+ *
+ * @param inst          Pointer to dw3000_dev_instance_t.
+ * @param reg           Register from where data is read.
+ * @param subaddress    Address where data is read.
+ * @param nbytes        Length of data.
+ * @return   buffer.value
+ */
+uint64_t
+dw3000_read_reg_cached(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, size_t nbytes)
+{
+#if MYNEWT_VAL(DW3000_REG_SHADOW)
+    uint64_t value = 0;
+    assert(nbytes <= sizeof(uint64_t));
+
+    for (int i = 0;i < DW3000_SHADOW_NUM;i++) {
+        const struct dw3000_shadow_reg * r = &dw3000_shadow_regs[i];
+        if (r->reg != reg || subaddress < r->offset || subaddress + nbytes > r->offset + r->len) {
+            continue;
+        }
+        if (!(inst->shadow_valid & (1UL << i))) {
+            dw3000_read(inst, r->reg, r->offset, inst->shadow[i], r->len);
+            /* Don't trust what was read from a sleeping device */
+            if (!inst->uwb_dev.status.sleeping) {
+                inst->shadow_valid |= (1UL << i);
+            }
+        }
+        memcpy(&value, &inst->shadow[i][subaddress - r->offset], nbytes);
+        return value;
+    }
+#endif
+    return dw3000_read_reg(inst, reg, subaddress, nbytes);
+}
+
+/**
+ * API to write a register unless the shadow cache shows it already holds
+ * val. Used for configuration that is committed repeatedly with mostly
+ * unchanged fields, registers without a valid shadow are always written.
+ *
+ * @param inst          Pointer to dw3000_dev_instance_t.
+ * @param reg           Register from where data is written into.
+ * @param subaddress    Address where writing of data begins.
+ * @param val           Value to be written.
+ * @param nbytes        Length of data.
+ * @return void
+ */
+void
+dw3000_write_reg_diff(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint64_t val, size_t nbytes)
+{
+#if MYNEWT_VAL(DW3000_REG_SHADOW)
+    assert(nbytes <= sizeof(uint64_t));
+
+    for (int i = 0;i < DW3000_SHADOW_NUM;i++) {
+        const struct dw3000_shadow_reg * r = &dw3000_shadow_regs[i];
+        if (r->reg != reg || r->masked || subaddress < r->offset || subaddress + nbytes > r->offset + r->len) {
+            continue;
+        }
+        if ((inst->shadow_valid & (1UL << i)) &&
+            memcmp(&inst->shadow[i][subaddress - r->offset], &val, nbytes) == 0) {
+            return;
+        }
+        break;
+    }
+#endif
+    dw3000_write_reg(inst, reg, subaddress, val, nbytes);
+}
+
+/**
+ * API to invalidate the register shadow cache. Must be called whenever the
+ * device registers may have changed without the host writing them, i.e.
+ * after reset or sleep.
+ *
+ * @param inst          Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_shadow_invalidate(dw3000_dev_instance_t * inst)
+{
+#if MYNEWT_VAL(DW3000_REG_SHADOW)
+    inst->shadow_valid = 0;
+#endif
+}
+
+/**
+ * API to reset a batch of SPI transfers.
+ *
+ * @param batch         Pointer to dw3000_spi_batch_t.
+ * @return void
+ */
+void
+dw3000_spi_batch_init(dw3000_spi_batch_t * batch)
+{
+    batch->count = 0;
+}
+
+/**
+ * API to prepare a single spi transfer, builds the transaction header.
+ *
+ * @param x             Pointer to dw3000_spi_xfer_t.
+ * @param reg           Member of dw3000_cmd_t structure.
+ * @param subaddress    Member of dw3000_cmd_t structure.
+ * @param operation     0 for read, 1 for write.
+ * @param buffer        Data buffer, NULL to use the local storage of the transfer.
+ * @param length        Represents buffer length.
+ * @return void
+ */
+void
+dw3000_spi_xfer_init(dw3000_spi_xfer_t * x, uint16_t reg, uint16_t subaddress,
+                     uint8_t operation, uint8_t * buffer, uint16_t length)
+{
+    dw3000_cmd_t cmd = {
+        .reg = reg,
+        .subindex = subaddress != 0,
+        .operation = operation,
+        .extended = subaddress > 0x7F,
+        .subaddress = subaddress
+    };
+
+    assert(reg <= 0x3F); // Record number is limited to 6-bits.
+    assert((subaddress <= 0x7FFF) && ((subaddress + length) <= 0x7FFF)); // Index and sub-addressable area are limited to 15-bits.
+    assert(buffer || length <= sizeof(x->data));
+
+    x->cmd[0] = cmd.operation << 7 | cmd.subindex << 6 | cmd.reg;
+    x->cmd[1] = cmd.extended << 7 | (uint8_t) (subaddress);
+    x->cmd[2] = (uint8_t) (subaddress >> 7);
+    x->cmd_size = cmd.subaddress?(cmd.extended?3:2):1;
+    x->is_write = operation;
+    x->buffer = (buffer) ? buffer : x->data;
+    x->length = length;
+}
+
+/**
+ * Append a transfer to a batch.
+ *
+ * @param batch         Pointer to dw3000_spi_batch_t.
+ * @param reg           Member of dw3000_cmd_t structure.
+ * @param subaddress    Member of dw3000_cmd_t structure.
+ * @param operation     0 for read, 1 for write.
+ * @param buffer        Data buffer, NULL to use the local storage of the transfer.
+ * @param length        Represents buffer length.
+ * @return int          Index of the transfer in the batch
+ */
+static int
+dw3000_spi_batch_add(dw3000_spi_batch_t * batch, uint16_t reg, uint16_t subaddress,
+                     uint8_t operation, uint8_t * buffer, uint16_t length)
+{
+    assert(batch->count < MYNEWT_VAL(DW3000_SPI_BATCH_MAX));
+    dw3000_spi_xfer_init(&batch->xfer[batch->count], reg, subaddress, operation, buffer, length);
+    return batch->count++;
+}
+
+/**
+ * API to queue a read into a batch. Data is available in buffer
+ * once the batch has been submitted.
+ *
+ * @param batch         Pointer to dw3000_spi_batch_t.
+ * @param reg           Member of dw3000_cmd_t structure.
+ * @param subaddress    Member of dw3000_cmd_t structure.
+ * @param buffer        Result is stored in buffer.
+ * @param length        Represents buffer length.
+ * @return int          Index of the transfer in the batch
+ */
+int
+dw3000_spi_batch_read(dw3000_spi_batch_t * batch, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length)
+{
+    assert(buffer);
+    return dw3000_spi_batch_add(batch, reg, subaddress, 0, buffer, length);
+}
+
+/**
+ * API to queue a write into a batch. The buffer must remain valid
+ * until the batch has been submitted.
+ *
+ * @param batch         Pointer to dw3000_spi_batch_t.
+ * @param reg           Member of dw3000_cmd_t structure.
+ * @param subaddress    Member of dw3000_cmd_t structure.
+ * @param buffer        Data to be written.
+ * @param length        Represents buffer length.
+ * @return int          Index of the transfer in the batch
+ */
+int
+dw3000_spi_batch_write(dw3000_spi_batch_t * batch, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length)
+{
+    assert(buffer);
+    return dw3000_spi_batch_add(batch, reg, subaddress, 1, buffer, length);
+}
+
+/**
+ * API to queue a register read into a batch. Use dw3000_spi_batch_value
+ * to retrieve the result once the batch has been submitted.
+ *
+ * @param batch         Pointer to dw3000_spi_batch_t.
+ * @param reg           Register from where data is read.
+ * @param subaddress    Address where data is read.
+ * @param nbytes        Length of data.
+ * @return int          Index of the transfer in the batch
+ */
+int
+dw3000_spi_batch_read_reg(dw3000_spi_batch_t * batch, uint16_t reg, uint16_t subaddress, size_t nbytes)
+{
+    assert(nbytes <= sizeof(uint64_t));
+    return dw3000_spi_batch_add(batch, reg, subaddress, 0, NULL, nbytes);
+}
+
+/**
+ * API to queue a register write into a batch.
+ *
+ * @param batch         Pointer to dw3000_spi_batch_t.
+ * @param reg           Register from where data is written into.
+ * @param subaddress    Address where writing of data begins.
+ * @param val           Value to be written.
+ * @param nbytes        Length of data.
+ * @return int          Index of the transfer in the batch
+ */
+int
+dw3000_spi_batch_write_reg(dw3000_spi_batch_t * batch, uint16_t reg, uint16_t subaddress, uint64_t val, size_t nbytes)
+{
+    int idx;
+    assert(nbytes <= sizeof(uint64_t));
+    idx = dw3000_spi_batch_add(batch, reg, subaddress, 1, NULL, nbytes);
+    memcpy(batch->xfer[idx].data, &val, sizeof(uint64_t));
+    return idx;
+}
+
+/**
+ * API to retrieve the result of a register read queued with
+ * dw3000_spi_batch_read_reg.
+ *
+ * @param batch         Pointer to dw3000_spi_batch_t.
+ * @param idx           Index returned by dw3000_spi_batch_read_reg.
+ * @return uint64_t     Register value
+ */
+uint64_t
+dw3000_spi_batch_value(dw3000_spi_batch_t * batch, int idx)
+{
+    uint64_t value = 0;
+    dw3000_spi_xfer_t * x = &batch->xfer[idx];
+    assert(idx < batch->count && x->buffer == x->data);
+    memcpy(&value, x->data, x->length);
+    return value;
+}
+
+/**
+ * API to submit an array of prepared transfers. All transfers are issued
+ * in order under a single acquisition of the spi bus and the shadow cache
+ * is updated with the data written. status.spi_error is set if any of the
+ * transfers failed.
+ *
+ * @param inst          Pointer to dw3000_dev_instance_t.
+ * @param xfer          Transfers prepared with dw3000_spi_xfer_init.
+ * @param count         Number of transfers.
+ * @return struct uwb_dev_status
+ */
+struct uwb_dev_status
+dw3000_spi_xfer_submit(dw3000_dev_instance_t * inst, dw3000_spi_xfer_t * xfer, uint8_t count)
+{
+    for (int i = 0;i < count;i++) {
+        dw3000_spi_xfer_t * x = &xfer[i];
+        if (x->is_write) {
+            dw3000_shadow_update(inst, x->cmd[0] & 0x3F,
+                                 (x->cmd_size > 1) ? ((x->cmd[1] & 0x7F) | ((uint16_t)x->cmd[2] << 7)) : 0,
+                                 x->buffer, x->length);
+        }
+    }
+    if (hal_dw3000_batch(inst, xfer, count) != DPL_OK) {
+        inst->uwb_dev.status.spi_error = 1;
+    }
+    return inst->uwb_dev.status;
+}
+
+/**
+ * API to submit a batch of transfers. All transfers are issued in order
+ * under a single acquisition of the spi bus, status.spi_error is set if
+ * any of them failed.
+ *
+ * @param inst          Pointer to dw3000_dev_instance_t.
+ * @param batch         Pointer to dw3000_spi_batch_t.
+ * @return struct uwb_dev_status
+ */
+struct uwb_dev_status
+dw3000_spi_batch_submit(dw3000_dev_instance_t * inst, dw3000_spi_batch_t * batch)
+{
+    return dw3000_spi_xfer_submit(inst, batch->xfer, batch->count);
+}
+
+#if MYNEWT_VAL(DW3000_HAL_SPI_ASYNC)
+/**
+ * API to prepare an asynchronous transfer, builds the transaction header.
+ *
+ * @param xfer          Transfer descriptor.
+ * @param reg           Member of dw3000_cmd_t structure.
+ * @param subaddress    Member of dw3000_cmd_t structure.
+ * @param operation     0 for read, 1 for write.
+ * @param buffer        Data buffer.
+ * @param length        Represents buffer length.
+ * @param cb            Completion callback, called from interrupt context.
+ * @param cb_arg        Argument passed to cb.
+ * @return void
+ */
+void
+dw3000_spi_async_init(dw3000_spi_async_t * xfer, uint16_t reg, uint16_t subaddress, uint8_t operation,
+                      uint8_t * buffer, uint16_t length, dw3000_spi_async_cb_t cb, void * cb_arg)
+{
+    dw3000_cmd_t cmd = {
+        .reg = reg,
+        .subindex = subaddress != 0,
+        .operation = operation,
+        .extended = subaddress > 0x7F,
+        .subaddress = subaddress
+    };
+
+    assert(xfer && buffer);
+    assert(reg <= 0x3F); // Record number is limited to 6-bits.
+    assert((subaddress <= 0x7FFF) && ((subaddress + length) <= 0x7FFF)); // Index and sub-addressable area are limited to 15-bits.
+
+    xfer->cmd[0] = cmd.operation << 7 | cmd.subindex << 6 | cmd.reg;
+    xfer->cmd[1] = cmd.extended << 7 | (uint8_t) (subaddress);
+    xfer->cmd[2] = (uint8_t) (subaddress >> 7);
+    xfer->cmd_size = cmd.subaddress?(cmd.extended?3:2):1;
+    xfer->is_write = operation;
+    xfer->buffer = buffer;
+    xfer->length = length;
+    xfer->cb = cb;
+    xfer->cb_arg = cb_arg;
+}
+
+/**
+ * Prepare and submit an asynchronous transfer.
+ *
+ * @param inst          Pointer to dw3000_dev_instance_t.
+ * @param reg           Member of dw3000_cmd_t structure.
+ * @param subaddress    Member of dw3000_cmd_t structure.
+ * @param operation     0 for read, 1 for write.
+ * @param buffer        Data buffer.
+ * @param length        Represents buffer length.
+ * @param xfer          Transfer descriptor, must remain valid until cb has been called.
+ * @param cb            Completion callback, called from interrupt context.
+ * @param cb_arg        Argument passed to cb.
+ * @return struct uwb_dev_status
+ */
+static struct uwb_dev_status
+dw3000_async_submit(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t operation,
+                    uint8_t * buffer, uint16_t length, dw3000_spi_async_t * xfer,
+                    dw3000_spi_async_cb_t cb, void * cb_arg)
+{
+    dw3000_spi_async_init(xfer, reg, subaddress, operation, buffer, length, cb, cb_arg);
+    hal_dw3000_async_submit(inst, xfer);
+    return inst->uwb_dev.status;
+}
+
+/**
+ * API to start an asynchronous read from given address. Returns as soon as the
+ * transfer has been started or queued, cb is called once buffer has been filled.
+ *
+ * @param inst          Pointer to dw3000_dev_instance_t.
+ * @param reg           Member of dw3000_cmd_t structure.
+ * @param subaddress    Member of dw3000_cmd_t structure.
+ * @param buffer        Result is stored in buffer.
+ * @param length        Represents buffer length.
+ * @param xfer          Transfer descriptor, must remain valid until cb has been called.
+ * @param cb            Completion callback, called from interrupt context.
+ * @param cb_arg        Argument passed to cb.
+ * @return struct uwb_dev_status
+ */
+struct uwb_dev_status
+dw3000_read_async(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length,
+                  dw3000_spi_async_t * xfer, dw3000_spi_async_cb_t cb, void * cb_arg)
+{
+    return dw3000_async_submit(inst, reg, subaddress, 0, buffer, length, xfer, cb, cb_arg);
+}
+
+/**
+ * API to start an asynchronous write into given address. The buffer must
+ * remain valid until cb has been called.
+ *
+ * @param inst          Pointer to dw3000_dev_instance_t.
+ * @param reg           Member of dw3000_cmd_t structure.
+ * @param subaddress    Member of dw3000_cmd_t structure.
+ * @param buffer        Data to be written.
+ * @param length        Represents buffer length.
+ * @param xfer          Transfer descriptor, must remain valid until cb has been called.
+ * @param cb            Completion callback, called from interrupt context.
+ * @param cb_arg        Argument passed to cb.
+ * @return struct uwb_dev_status
+ */
+struct uwb_dev_status
+dw3000_write_async(dw3000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length,
+                   dw3000_spi_async_t * xfer, dw3000_spi_async_cb_t cb, void * cb_arg)
+{
+    dw3000_shadow_update(inst, reg, subaddress, buffer, length);
+    return dw3000_async_submit(inst, reg, subaddress, 1, buffer, length, xfer, cb, cb_arg);
+}
+#endif
+
+#if MYNEWT_VAL(DW3000_SPI_NOBLOCK_AUTOTUNE)
+//! Read lengths measured by dw3000_spi_tune_noblock, in increasing order
+static const uint16_t dw3000_spi_tune_lengths[] = {4, 8, 12, 16, 24, 32, 48, 64, 96, 128};
+#define DW3000_SPI_TUNE_NUM (sizeof(dw3000_spi_tune_lengths)/sizeof(dw3000_spi_tune_lengths[0]))
+#define DW3000_SPI_TUNE_REPEAT (4)
+#endif
+
+/**
+ * API to measure the cost of blocking and non-blocking spi reads at the
+ * current spi baudrate and select the length from which non-blocking io is used.
+ * The crossover is the shortest length where a non-blocking read, including
+ * waiting for it to complete, is no slower than a blocking read. The best of
+ * a few repetitions is used for each length. Lengths are transfer lengths,
+ * command header included, as compared against spi_rd_max_noblock by the
+ * read functions. The result is never below DW3000_DEVICE_SPI_RD_MAX_NOBLOCK
+ * so short reads always stay blocking. Needs to be called after each change
+ * of the spi baudrate.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_spi_tune_noblock(dw3000_dev_instance_t * inst)
+{
+#if MYNEWT_VAL(DW3000_SPI_NOBLOCK_AUTOTUNE)
+    /* Reads from the start of the rx buffer have no side effects */
+    const uint8_t header[] = {RX_BUFFER_ID};
+    uint8_t buffer[128];
+    uint32_t t0, blocking, noblock;
+    uint16_t i, j;
+
+    assert(dw3000_spi_tune_lengths[DW3000_SPI_TUNE_NUM-1] <= sizeof(buffer));
+    inst->spi_rd_max_noblock = sizeof(header) + dw3000_spi_tune_lengths[DW3000_SPI_TUNE_NUM-1] + 1;
+
+    for (i = 0;i < DW3000_SPI_TUNE_NUM;i++) {
+        uint16_t length = dw3000_spi_tune_lengths[i];
+        if (sizeof(header) + length < MYNEWT_VAL(DW3000_DEVICE_SPI_RD_MAX_NOBLOCK)) {
+            /* Always blocking, no need to measure */
+            continue;
+        }
+        blocking = noblock = UINT32_MAX;
+        for (j = 0;j < DW3000_SPI_TUNE_REPEAT;j++) {
+            t0 = dpl_cputime_get32();
+            hal_dw3000_read(inst, header, sizeof(header), buffer, length);
+            t0 = dpl_cputime_get32() - t0;
+            blocking = (t0 < blocking) ? t0 : blocking;
+
+            t0 = dpl_cputime_get32();
+            hal_dw3000_read_noblock(inst, header, sizeof(header), buffer, length);
+            hal_dw3000_rw_noblock_wait(inst, DPL_TIMEOUT_NEVER);
+            t0 = dpl_cputime_get32() - t0;
+            noblock = (t0 < noblock) ? t0 : noblock;
+        }
+        if (noblock <= blocking) {
+            inst->spi_rd_max_noblock = sizeof(header) + length;
+            break;
+        }
+    }
+    if (inst->spi_rd_max_noblock < MYNEWT_VAL(DW3000_DEVICE_SPI_RD_MAX_NOBLOCK)) {
+        inst->spi_rd_max_noblock = MYNEWT_VAL(DW3000_DEVICE_SPI_RD_MAX_NOBLOCK);
+    }
+#endif
+}
+
+/**
+ * API to feed the clock domain state machine. The state decides the fastest
+ * legal spi baudrate: full speed only while the system clock runs on the
+ * locked PLL, low speed otherwise. The bus is switched lazily, on the next
+ * transfer, and only if the baudrate actually changes.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param ev    Clock event, see dw3000_clk_event_t.
+ * @return void
+ */
+void
+dw3000_clk_event(dw3000_dev_instance_t * inst, dw3000_clk_event_t ev)
+{
+    uint8_t state = inst->clk_state;
+
+    switch (ev) {
+    case DW3000_CLK_EV_RESET:
+        state = DW3000_CLK_INIT;
+        break;
+    case DW3000_CLK_EV_SLEEP:
+        state = DW3000_CLK_SLEEP;
+        break;
+    case DW3000_CLK_EV_WAKEUP:
+        if (state == DW3000_CLK_SLEEP) {
+            state = DW3000_CLK_INIT;
+        }
+        break;
+    case DW3000_CLK_EV_TEST:
+        state = DW3000_CLK_TEST;
+        break;
+    case DW3000_CLK_EV_XTAL:
+        if (state != DW3000_CLK_TEST) {
+            state = DW3000_CLK_XTAL;
+        }
+        break;
+    case DW3000_CLK_EV_PLL:
+    case DW3000_CLK_EV_SEQ:
+        /* Still on XTI until the PLL is seen locked */
+        if (state != DW3000_CLK_TEST && state != DW3000_CLK_SLEEP) {
+            state = DW3000_CLK_INIT;
+        }
+        break;
+    case DW3000_CLK_EV_PLL_LOCK:
+        if (state == DW3000_CLK_INIT) {
+            state = DW3000_CLK_PLL;
+        }
+        break;
+    }
+    inst->clk_state = state;
+}
+
+/**
+ * API to feed DW3000_CLK_EV_PLL_LOCK to the clock domain state machine if the
+ * clock PLL is locked. Uses the live lock status, CPLOCK is latched and may
+ * have been cleared since the PLL locked.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_clk_check_lock(dw3000_dev_instance_t * inst)
+{
+    if (inst->clk_state != DW3000_CLK_INIT) {
+        return;
+    }
+    if (dw3000_read_reg(inst, RF_CONF_ID, RF_STATUS_OFFSET, sizeof(uint8_t)) & RF_STATUS_CPLLLOCK) {
+        dw3000_clk_event(inst, DW3000_CLK_EV_PLL_LOCK);
+    }
+}
+
 /**
  * API to do softreset on dw3000 by writing data into PMSC_CTRL0_SOFTRESET_OFFSET.
  *
@@ -261,6 +1286,8 @@ dw3000_softreset(dw3000_dev_instance_t * inst)
     dpl_cputime_delay_usecs(10);
 
     dw3000_write_reg(inst, PMSC_ID, PMSC_CTRL0_SOFTRESET_OFFSET, PMSC_CTRL0_RESET_CLEAR, sizeof(uint8_t)); // Clear reset
+    dw3000_shadow_invalidate(inst);
+    dw3000_clk_event(inst, DW3000_CLK_EV_RESET);
 }
 
 
@@ -273,18 +1300,14 @@ dw3000_softreset(dw3000_dev_instance_t * inst)
 int
 dw3000_dev_config(dw3000_dev_instance_t * inst)
 {
-    int rc;
     int timeout = 3;
 
 retry:
-    inst->spi_settings.baudrate = inst->spi_baudrate_low;
+    /* Reset puts the clock domain back on XTAL, the bus is reconfigured
+     * for the low baudrate on the next transfer */
     hal_dw3000_reset(inst);
-    rc = hal_spi_disable(inst->spi_num);
-    assert(rc == 0);
-    rc = hal_spi_config(inst->spi_num, &inst->spi_settings);
-    assert(rc == 0);
-    rc = hal_spi_enable(inst->spi_num);
-    assert(rc == 0);
+    hal_dw3000_spi_unbind(inst);
+    dw3000_shadow_invalidate(inst);
 
     inst->uwb_dev.device_id = dw3000_read_reg(inst, DEV_ID_ID, 0, sizeof(uint32_t));
     inst->uwb_dev.status.initialized = (inst->uwb_dev.device_id == DWT_DEVICE_ID);
@@ -300,16 +1323,10 @@ retry:
         return DPL_TIMEOUT;
     }
 
+    /* Leaves the system clock with the sequencer, the SPI baudrate
+     * goes up to > 4M with the next transfer */
     dw3000_phy_init(inst, NULL);
-
-    /* It's now safe to increase the SPI baudrate > 4M */
-    inst->spi_settings.baudrate = inst->spi_baudrate;
-    rc = hal_spi_disable(inst->spi_num);
-    assert(rc == 0);
-    rc = hal_spi_config(inst->spi_num, &inst->spi_settings);
-    assert(rc == 0);
-    rc = hal_spi_enable(inst->spi_num);
-    assert(rc == 0);
+    dw3000_spi_tune_noblock(inst);
 
     inst->uwb_dev.pan_id = MYNEWT_VAL(PANID);
     inst->uwb_dev.uid = inst->part_id & 0xffff;
@@ -380,7 +1397,7 @@ dw3000_dev_set_sleep_timer(dw3000_dev_instance_t * inst, uint16_t count)
 void
 dw3000_dev_configure_sleep(dw3000_dev_instance_t * inst)
 {
-    uint16_t reg = dw3000_read_reg(inst, AON_ID, AON_WCFG_OFFSET, sizeof(uint16_t));
+    uint16_t reg = dw3000_read_reg_cached(inst, AON_ID, AON_WCFG_OFFSET, sizeof(uint16_t));
     reg |= AON_WCFG_ONW_L64P | AON_WCFG_ONW_LDC;
 
     if (inst->uwb_dev.status.LDE_enabled)
@@ -399,7 +1416,7 @@ dw3000_dev_configure_sleep(dw3000_dev_instance_t * inst)
         reg &= ~AON_WCFG_ONW_RX;
 
     dw3000_write_reg(inst, AON_ID, AON_WCFG_OFFSET, reg, sizeof(uint16_t));
-    reg = dw3000_read_reg(inst, AON_ID, AON_CFG0_OFFSET, sizeof(uint16_t));
+    reg = dw3000_read_reg_cached(inst, AON_ID, AON_CFG0_OFFSET, sizeof(uint16_t));
     reg |= AON_CFG0_WAKE_SPI | AON_CFG0_WAKE_PIN;
 
     inst->uwb_dev.status.sleep_enabled = inst->uwb_dev.config.sleep_enable;
@@ -430,6 +1447,8 @@ dw3000_dev_enter_sleep(dw3000_dev_instance_t * inst)
     dw3000_write_reg(inst, AON_ID, AON_CTRL_OFFSET, 0x0, sizeof(uint16_t));
     dw3000_write_reg(inst, AON_ID, AON_CTRL_OFFSET, AON_CTRL_SAVE, sizeof(uint16_t));
     inst->uwb_dev.status.sleeping = 1;
+    dw3000_shadow_invalidate(inst);
+    dw3000_clk_event(inst, DW3000_CLK_EV_SLEEP);
 
     // Critical region, unlock mutex
     err = dpl_mutex_release(&inst->mutex);
@@ -459,6 +1478,8 @@ dw3000_dev_wakeup(dw3000_dev_instance_t * inst)
     /* Set sleeping status bit to zero here to allow a wakeup irq
      * to be captured. */
     inst->uwb_dev.status.sleeping = 0;
+    /* The device wakes up on XTAL, talk to it at low speed until the PLL locks */
+    dw3000_clk_event(inst, DW3000_CLK_EV_WAKEUP);
     devid = dw3000_read_reg(inst, DEV_ID_ID, 0, sizeof(uint32_t));
 
     while (devid != 0xDECA0130 && --timeout)
@@ -467,6 +1488,13 @@ dw3000_dev_wakeup(dw3000_dev_instance_t * inst)
         devid = dw3000_read_reg(inst, DEV_ID_ID, 0, sizeof(uint32_t));
     }
     inst->uwb_dev.status.sleeping = (devid != DWT_DEVICE_ID);
+    /* Registers not kept in the AON array are back at their defaults */
+    dw3000_shadow_invalidate(inst);
+    /* Go back to full speed right away if the PLL has already locked,
+     * otherwise the MCPLOCK interrupt does it */
+    if (!inst->uwb_dev.status.sleeping) {
+        dw3000_clk_check_lock(inst);
+    }
     dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_SLP2INIT, sizeof(uint32_t));
     dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_ALL_RX_ERR, sizeof(uint32_t));
 
@@ -502,7 +1530,7 @@ mtx_error:
 struct uwb_dev_status
 dw3000_dev_enter_sleep_after_tx(dw3000_dev_instance_t * inst, uint8_t enable)
 {
-    uint32_t reg = dw3000_read_reg(inst, PMSC_ID, PMSC_CTRL1_OFFSET, sizeof(uint32_t));
+    uint32_t reg = dw3000_read_reg_cached(inst, PMSC_ID, PMSC_CTRL1_OFFSET, sizeof(uint32_t));
 
     inst->control.sleep_after_tx = enable;
     if(inst->control.sleep_after_tx)
@@ -527,7 +1555,7 @@ dw3000_dev_enter_sleep_after_tx(dw3000_dev_instance_t * inst, uint8_t enable)
 struct uwb_dev_status
 dw3000_dev_enter_sleep_after_rx(dw3000_dev_instance_t * inst, uint8_t enable)
 {
-    uint32_t reg = dw3000_read_reg(inst, PMSC_ID, PMSC_CTRL1_OFFSET, sizeof(uint32_t));
+    uint32_t reg = dw3000_read_reg_cached(inst, PMSC_ID, PMSC_CTRL1_OFFSET, sizeof(uint32_t));
     inst->control.sleep_after_rx = enable;
     if(inst->control.sleep_after_rx)
         reg |= PMSC_CTRL1_ARXSLP;
@@ -998,6 +2026,50 @@ dw3000_dev_init(struct os_dev *odev, void *arg)
     inst->irq_pin = cfg->irq_pin;
     inst->rst_pin = cfg->rst_pin;
     inst->ss_pin  = cfg->ss_pin;
+    inst->spi_rd_max_noblock = MYNEWT_VAL(DW3000_DEVICE_SPI_RD_MAX_NOBLOCK);
+    inst->spi_irq_task = NULL;
+#if MYNEWT_VAL(DW3000_SPI_WRITE_VERIFY)
+    inst->spi_baudrate_max = cfg->spi_baudrate;
+    inst->spi_wv_errs = 0;
+    inst->spi_wv_good = 0;
+    dpl_event_init(&inst->spi_tune_ev, dw3000_spi_tune_ev_cb, (void *)inst);
+#endif
+#if MYNEWT_VAL(DW3000_SPI_WC_MAX)
+    inst->wc_active = 0;
+    inst->wc_task = NULL;
+    inst->wc_len = 0;
+#endif
+#if MYNEWT_VAL(DW3000_MAC_PROFILES)
+    for (int i = 0;i < MYNEWT_VAL(DW3000_MAC_PROFILES);i++) {
+        inst->profiles[i].count = 0;
+    }
+    inst->profile = 0xFF;
+#endif
+#if MYNEWT_VAL(DW3000_CB_DISPATCH_MAX)
+    inst->cb_table.valid = 0;
+#endif
+#if MYNEWT_VAL(DW3000_RX_DEMUX_MAX)
+    inst->demux_count = 0;
+    inst->demux_hdr = 0;
+#endif
+#if MYNEWT_VAL(DW3000_RX_FILTER_MAX)
+    inst->rx_filter.active = 0;
+#endif
+#if MYNEWT_VAL(DW3000_RX_LAZY_HDR)
+    inst->rx_hdr_cb = NULL;
+    inst->rx_fetched = 0;
+    inst->rx_frame_len = 0;
+#endif
+#if MYNEWT_VAL(DW3000_RX_RING_LEN)
+    inst->rx_ring_head = 0;
+    inst->rx_ring_tail = 0;
+    inst->rx_ring_attached = 0;
+    err = dpl_sem_init(&inst->rx_ring_sem, 0);
+    assert(err == DPL_OK);
+#endif
+#if !defined(MYNEWT) && MYNEWT_VAL(DW3000_HAL_SPIDEV)
+    inst->spidev_fd = -1;
+#endif
 
     udev->rx_antenna_delay = cfg->rx_antenna_delay;
     udev->tx_antenna_delay = cfg->tx_antenna_delay;
@@ -1017,7 +2089,7 @@ dw3000_dev_init(struct os_dev *odev, void *arg)
 
     SLIST_INIT(&inst->uwb_dev.interface_cbs);
 
-#if MYNEWT_VAL(DW3000_SPI_BACKTRACE_LEN) || MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)
+#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)
     inst->bt_ticks2usec = 1000000/MYNEWT_VAL(OS_CPUTIME_FREQ);
 #endif
     return DPL_OK;
@@ -1034,8 +2106,15 @@ dw3000_dev_deinit(dw3000_dev_instance_t * inst)
 {
     assert(inst);
     hal_spi_disable(inst->spi_num);
+#if !defined(MYNEWT) && MYNEWT_VAL(DW3000_HAL_SPIDEV)
+    hal_dw3000_spidev_close(inst);
+#endif
 
     /* De-Initialise task structures in uwb_dev */
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+    dpl_cputime_timer_stop(&inst->irq_poll.timer);
+    inst->irq_poll.active = 0;
+#endif
     uwb_task_deinit(&inst->uwb_dev);
     hal_gpio_irq_disable(inst->irq_pin);
     hal_gpio_irq_release(inst->irq_pin);
@@ -49,7 +49,7 @@ void
 dw3000_gpio_set_mode(struct _dw3000_dev_instance_t * inst, uint8_t gpioNum, uint8_t mode)
 {
     uint32_t reg;
-    reg = (uint32_t) dw3000_read_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
+    reg = (uint32_t) dw3000_read_reg_cached(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
     reg &= ~(0x3UL << (6+gpioNum*2));
     reg |= (mode << (6+gpioNum*2));
     dw3000_write_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, reg, sizeof(uint32_t));
@@ -68,7 +68,7 @@ uint8_t
 dw3000_gpio_get_mode(struct _dw3000_dev_instance_t * inst, uint8_t gpioNum)
 {
     uint32_t reg;
-    reg = (uint32_t) dw3000_read_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
+    reg = (uint32_t) dw3000_read_reg_cached(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
     reg &= (0x3UL << (6+gpioNum*2));
     reg >>= (6+gpioNum*2);
     return (uint8_t)(reg&0x3);
@@ -85,7 +85,7 @@ void dw3000_gpio4_config_ext_pa(struct _dw3000_dev_instance_t * inst)
 {
     uint32_t reg;
 
-        reg = (uint32_t) dw3000_read_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
+        reg = (uint32_t) dw3000_read_reg_cached(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
         reg &= ~GPIO_MSGP4_MASK;
         reg |= GPIO_PIN4_EXTPA;
         dw3000_write_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, reg, sizeof(uint32_t));
@@ -95,7 +95,7 @@ void dw3000_gpio5_config_ext_txe(struct _dw3000_dev_instance_t * inst)
 {
     uint32_t reg;
 
-        reg = (uint32_t) dw3000_read_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
+        reg = (uint32_t) dw3000_read_reg_cached(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
         reg &= ~GPIO_MSGP5_MASK;
         reg |= GPIO_PIN5_EXTTXE;
         dw3000_write_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, reg, sizeof(uint32_t));
@@ -105,7 +105,7 @@ void dw3000_gpio6_config_ext_rxe(struct _dw3000_dev_instance_t * inst)
 {
     uint32_t reg;
 
-        reg = (uint32_t) dw3000_read_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
+        reg = (uint32_t) dw3000_read_reg_cached(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
         reg &= ~GPIO_MSGP6_MASK;
         reg |= GPIO_PIN6_EXTRXE;
         dw3000_write_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, reg, sizeof(uint32_t));
@@ -130,7 +130,7 @@ void dw3000_gpio_config_leds(struct _dw3000_dev_instance_t * inst, dw3000_led_mo
 
     if (mode & DWT_LEDS_ENABLE){
         // Set up MFIO for LED output.
-        reg = (uint32_t) dw3000_read_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
+        reg = (uint32_t) dw3000_read_reg_cached(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, sizeof(uint32_t));
         reg &= ~(GPIO_MSGP2_MASK | GPIO_MSGP3_MASK);
         reg |= (GPIO_PIN2_RXLED | GPIO_PIN3_TXLED);
         dw3000_write_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, reg, sizeof(uint32_t));
@@ -153,7 +153,7 @@ void dw3000_gpio_config_leds(struct _dw3000_dev_instance_t * inst, dw3000_led_mo
         }
     }else{
         // Clear the GPIO bits that are used for LED control.
-        reg = dw3000_read_reg(inst,GPIO_CTRL_ID, GPIO_MODE_OFFSET,sizeof(uint32_t));
+        reg = dw3000_read_reg_cached(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET,sizeof(uint32_t));
         reg &= ~(GPIO_MSGP2_MASK | GPIO_MSGP3_MASK);
         dw3000_write_reg(inst, GPIO_CTRL_ID, GPIO_MODE_OFFSET, reg, sizeof(uint32_t));
     }
@@ -217,7 +217,7 @@ dw3000_gpio_get_direction(struct _dw3000_dev_instance_t * inst, uint8_t gpioNum)
 
     assert(gpioNum < 9);
 
-    reg = dw3000_read_reg(inst, GPIO_CTRL_ID, GPIO_DIR_OFFSET, sizeof(uint32_t));
+    reg = dw3000_read_reg_cached(inst, GPIO_CTRL_ID, GPIO_DIR_OFFSET, GPIO_DIR_LEN);
 
     if (gpioNum < 4) {
         res = (uint8_t)(0x1 & (reg >> gpioNum));
@@ -37,6 +37,13 @@
 #include <hal/hal_gpio.h>
 #include <dw3000-c0/dw3000_hal.h>
 #include <dpl/dpl_cputime.h>
+#if !defined(MYNEWT) && MYNEWT_VAL(DW3000_HAL_SPIDEV)
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#endif
 
 #include <mcu/mcu.h>
 
@@ -244,104 +251,858 @@ static dw3000_dev_instance_t hal_dw3000_instances[]= {
 };
 #endif
 
-#if MYNEWT_VAL(DW3000_DEVICE_0) || MYNEWT_VAL(DW3000_DEVICE_1) || MYNEWT_VAL(DW3000_DEVICE_2)
+#if MYNEWT_VAL(DW3000_DEVICE_0) || MYNEWT_VAL(DW3000_DEVICE_1) || MYNEWT_VAL(DW3000_DEVICE_2)
+
+#if MYNEWT_VAL(DW3000_HAL_SPI_ZERO_COPY_MIN) || MYNEWT_VAL(DW3000_HAL_SPI_ASYNC)
+/* Zero-copy reads clock out zeros from here while the response is
+ * DMA'd into the caller's buffer. Kept in RAM as not all spi DMA
+ * engines can read from flash. Shared by all instances as it's never
+ * written to. */
+static uint8_t hal_dw3000_zero_tx[MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT)];
+#endif
+
+#define HAL_DW3000_SPI_BUS_MAX (3)
+
+//! Completion dispatcher of a spi bus shared by one or more instances
+static struct hal_dw3000_spi_bus {
+    uint8_t used;                               //!< Entry in use
+    uint8_t bound;                              //!< Dispatcher registered as txrx_cb of the bus
+    uint8_t spi_num;                            //!< SPI number
+    struct _dw3000_dev_instance_t * owner;      //!< Instance owning the transfer in flight
+    uint8_t busy;                               //!< Bus granted to a task or an asynchronous chain
+    uint8_t pending[DW3000_SPI_PRIO_NUM];       //!< Number of tasks waiting for the bus per class
+    struct dpl_sem grant[DW3000_SPI_PRIO_NUM];  //!< Released to hand the bus to a waiter of the class
+    uint8_t configured;                         //!< settings is what the bus is configured for
+    struct hal_spi_settings settings;           //!< Settings of the last hal_spi_config
+} hal_dw3000_spi_bus[HAL_DW3000_SPI_BUS_MAX];
+
+/**
+ * Interrupt context txrx_cb registered once per spi bus. Forwards the
+ * completion to the instance owning the transfer in flight.
+ *
+ * @param arg   Pointer to struct hal_dw3000_spi_bus.
+ * @param len   Length of the completed transfer.
+ * @return void
+ */
+static void
+hal_dw3000_spi_dispatch_cb(void *arg, int len)
+{
+    struct hal_dw3000_spi_bus * bus = arg;
+    assert(bus->owner);
+    hal_dw3000_spi_txrx_cb(bus->owner, len);
+}
+
+/**
+ * Find, or allocate, the dispatcher entry of the spi bus used by inst.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return struct hal_dw3000_spi_bus
+ */
+static struct hal_dw3000_spi_bus *
+hal_dw3000_spi_bus_get(struct _dw3000_dev_instance_t * inst)
+{
+    os_sr_t sr;
+    struct hal_dw3000_spi_bus * bus = NULL;
+
+    DPL_ENTER_CRITICAL(sr);
+    for (int i = 0;i < HAL_DW3000_SPI_BUS_MAX;i++) {
+        if (hal_dw3000_spi_bus[i].used && hal_dw3000_spi_bus[i].spi_num == inst->spi_num) {
+            bus = &hal_dw3000_spi_bus[i];
+            break;
+        }
+        if (!hal_dw3000_spi_bus[i].used && bus == NULL) {
+            bus = &hal_dw3000_spi_bus[i];
+        }
+    }
+    assert(bus);
+    if (!bus->used) {
+        bus->used = 1;
+        bus->bound = 0;
+        bus->busy = 0;
+        bus->spi_num = inst->spi_num;
+        for (int i = 0;i < DW3000_SPI_PRIO_NUM;i++) {
+            bus->pending[i] = 0;
+            dpl_sem_init(&bus->grant[i], 0);
+        }
+    }
+    DPL_EXIT_CRITICAL(sr);
+    return bus;
+}
+
+/**
+ * Make inst the owner of the next nonblocking transfer on its spi bus.
+ * The dispatcher is registered with the spi driver on first use only.
+ * Called with the spi bus acquired.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return int  DPL_OK on success, error otherwise
+ */
+static int
+hal_dw3000_spi_claim(struct _dw3000_dev_instance_t * inst)
+{
+    int rc = DPL_OK;
+    struct hal_dw3000_spi_bus * bus = hal_dw3000_spi_bus_get(inst);
+
+    if (!bus->bound) {
+        rc = hal_spi_disable(inst->spi_num);
+        rc |= hal_spi_set_txrx_cb(inst->spi_num, hal_dw3000_spi_dispatch_cb, (void*)bus);
+        rc |= hal_spi_enable(inst->spi_num);
+        if (rc != DPL_OK) {
+            return rc;
+        }
+        bus->bound = 1;
+    }
+    bus->owner = inst;
+    return rc;
+}
+
+/**
+ * API to force the completion dispatcher to be registered again and the bus
+ * to be reconfigured before the next transfer. Needed if another driver sharing
+ * the bus has replaced the txrx_cb or changed the spi settings.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+hal_dw3000_spi_unbind(struct _dw3000_dev_instance_t * inst)
+{
+    struct hal_dw3000_spi_bus * bus = hal_dw3000_spi_bus_get(inst);
+    bus->bound = 0;
+    bus->configured = 0;
+}
+
+/**
+ * Check if the bus is configured as the clock domain of inst requires.
+ * Touches no hardware, usable from interrupt context.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param bus   Pointer to the hal_dw3000_spi_bus of inst.
+ * @return bool true if no reconfiguration is needed
+ */
+static bool
+hal_dw3000_spi_clk_synced(struct _dw3000_dev_instance_t * inst, struct hal_dw3000_spi_bus * bus)
+{
+#if !defined(MYNEWT) && MYNEWT_VAL(DW3000_HAL_SPIDEV)
+    (void)inst;
+    (void)bus;
+    return true;
+#else
+    int baudrate = (inst->clk_state == DW3000_CLK_PLL) ? inst->spi_baudrate : inst->spi_baudrate_low;
+    return bus->configured &&
+        bus->settings.baudrate == baudrate &&
+        bus->settings.data_mode == inst->spi_settings.data_mode &&
+        bus->settings.data_order == inst->spi_settings.data_order &&
+        bus->settings.word_size == inst->spi_settings.word_size;
+#endif
+}
+
+/**
+ * Configure the bus for the fastest baudrate the clock domain of inst allows,
+ * if it isn't already. Instances sharing a bus only reconfigure it when their
+ * settings differ, the completion dispatcher stays registered as the spi
+ * drivers keep the txrx_cb over a reconfiguration. Called with the spi bus
+ * acquired.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param bus   Pointer to the hal_dw3000_spi_bus of inst.
+ * @return void
+ */
+static void
+hal_dw3000_spi_clk_sync(struct _dw3000_dev_instance_t * inst, struct hal_dw3000_spi_bus * bus)
+{
+    inst->spi_settings.baudrate = (inst->clk_state == DW3000_CLK_PLL) ? inst->spi_baudrate : inst->spi_baudrate_low;
+#if !defined(MYNEWT) && MYNEWT_VAL(DW3000_HAL_SPIDEV)
+    /* spidev takes the speed with every message, nothing to configure */
+    (void)bus;
+#else
+    int rc;
+    if (hal_dw3000_spi_clk_synced(inst, bus)) {
+        return;
+    }
+    rc = hal_spi_disable(inst->spi_num);
+    assert(rc == 0);
+    rc = hal_spi_config(inst->spi_num, &inst->spi_settings);
+    assert(rc == 0);
+    rc = hal_spi_enable(inst->spi_num);
+    assert(rc == 0);
+    bus->settings = inst->spi_settings;
+    bus->configured = 1;
+#endif
+}
+
+#if MYNEWT_VAL(DW3000_SPI_WC_MAX)
+static int hal_dw3000_wc_flush_locked(struct _dw3000_dev_instance_t * inst);
+#endif
+
+/**
+ * API to get the arbitration class of a transfer made without an explicit
+ * class. Transfers of the task running the interrupt bottom half of inst,
+ * callbacks included, get DW3000_SPI_PRIO_IRQ, all others DW3000_SPI_PRIO_MAC.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return uint8_t  Arbitration class, see dw3000_spi_prio_t.
+ */
+uint8_t
+hal_dw3000_spi_prio(struct _dw3000_dev_instance_t * inst)
+{
+    void * task = inst->spi_irq_task;
+    return (task && task == dpl_get_current_task_id()) ? DW3000_SPI_PRIO_IRQ : DW3000_SPI_PRIO_MAC;
+}
+
+/**
+ * Hand the bus over to the oldest waiter of the most urgent class pending,
+ * or mark it free if nobody waits. The waiter owns the bus as soon as its
+ * grant is released, nobody else can take it in between. Usable from
+ * interrupt context.
+ *
+ * @param bus   Pointer to the hal_dw3000_spi_bus of the instance.
+ * @return void
+ */
+static void
+hal_dw3000_bus_grant(struct hal_dw3000_spi_bus * bus)
+{
+    os_sr_t sr;
+    dpl_error_t err;
+
+    DPL_ENTER_CRITICAL(sr);
+    for (int i = 0;i < DW3000_SPI_PRIO_NUM;i++) {
+        if (bus->pending[i]) {
+            bus->pending[i]--;
+            DPL_EXIT_CRITICAL(sr);
+            err = dpl_sem_release(&bus->grant[i]);
+            assert(err == DPL_OK);
+            return;
+        }
+    }
+    bus->busy = 0;
+    DPL_EXIT_CRITICAL(sr);
+}
+
+/**
+ * API to acquire the spi bus of an instance. A free bus is taken at once,
+ * otherwise the caller waits in the queue of its class until the owner
+ * releases the bus with hal_dw3000_bus_release, which hands it to the most
+ * urgent class waiting. Long transfers of the bulk class are split so that
+ * this happens between chunks.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param prio  Arbitration class, see dw3000_spi_prio_t.
+ * @return int  DPL_OK on success, error otherwise
+ */
+int
+hal_dw3000_bus_acquire(struct _dw3000_dev_instance_t * inst, uint8_t prio)
+{
+    int rc = DPL_OK;
+    os_sr_t sr;
+    bool wait = false;
+    struct hal_dw3000_spi_bus * bus = hal_dw3000_spi_bus_get(inst);
+    assert(prio < DW3000_SPI_PRIO_NUM);
+
+    DPL_ENTER_CRITICAL(sr);
+    if (bus->busy) {
+        bus->pending[prio]++;
+        wait = true;
+    } else {
+        bus->busy = 1;
+    }
+    DPL_EXIT_CRITICAL(sr);
+
+    if (wait) {
+        rc = dpl_sem_pend(&bus->grant[prio], DPL_TIMEOUT_NEVER);
+        if (rc != DPL_OK) {
+            return rc;
+        }
+    }
+
+    /* Other drivers on the bus only know spi_sem */
+    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    if (rc != DPL_OK) {
+        hal_dw3000_bus_grant(bus);
+        return rc;
+    }
+
+    hal_dw3000_spi_clk_sync(inst, bus);
+#if MYNEWT_VAL(DW3000_SPI_WC_MAX)
+    /* A combined write still pending goes out before anything else */
+    if (inst->wc_len) {
+        hal_dw3000_wc_flush_locked(inst);
+    }
+#endif
+    return rc;
+}
+
+/**
+ * API to release the spi bus acquired with hal_dw3000_bus_acquire and hand it
+ * to the most urgent waiter, if any. Usable from interrupt context, where
+ * nonblocking and asynchronous transfers complete.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return int  DPL_OK on success, error otherwise
+ */
+int
+hal_dw3000_bus_release(struct _dw3000_dev_instance_t * inst)
+{
+    dpl_error_t err;
+    err = dpl_sem_release(inst->spi_sem);
+    hal_dw3000_bus_grant(hal_dw3000_spi_bus_get(inst));
+    return err;
+}
+
+/**
+ * API to choose DW3000 instances based on parameters.
+ *
+ * @param idx  Indicates number of instances for the chosen bsp.
+ * @return dw3000_dev_instance_t
+ */
+
+struct _dw3000_dev_instance_t *
+hal_dw3000_inst(uint8_t idx)
+{
+    if (idx < ARRAY_SIZE(hal_dw3000_instances)) {
+        return &hal_dw3000_instances[idx];
+    }
+    return 0;
+}
+
+/**
+ * API to reset all the gpio pins.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+hal_dw3000_reset(struct _dw3000_dev_instance_t * inst)
+{
+    assert(inst);
+
+    hal_gpio_init_out(inst->ss_pin, 1);
+    hal_gpio_init_out(inst->rst_pin, 0);
+
+    hal_gpio_write(inst->rst_pin, 0);
+    dpl_cputime_delay_usecs(1);
+    hal_gpio_write(inst->rst_pin, 1);
+    hal_gpio_init_in(inst->rst_pin, HAL_GPIO_PULL_NONE);
+
+    dpl_cputime_delay_usecs(5000);
+    dw3000_clk_event(inst, DW3000_CLK_EV_RESET);
+}
+
+#if !defined(MYNEWT) && MYNEWT_VAL(DW3000_HAL_SPIDEV)
+/**
+ * Open and configure the spidev device of an instance.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return int  DPL_OK on success, error otherwise
+ */
+static int
+hal_dw3000_spidev_open(struct _dw3000_dev_instance_t * inst)
+{
+    char path[32];
+    uint8_t mode;
+    uint8_t lsb_first = (inst->spi_settings.data_order == HAL_SPI_LSB_FIRST);
+    uint8_t bits = 8;
+    uint32_t speed = inst->spi_settings.baudrate * 1000;
+
+    switch (inst->spi_settings.data_mode) {
+    case HAL_SPI_MODE1:
+        mode = SPI_MODE_1;
+        break;
+    case HAL_SPI_MODE2:
+        mode = SPI_MODE_2;
+        break;
+    case HAL_SPI_MODE3:
+        mode = SPI_MODE_3;
+        break;
+    default:
+        mode = SPI_MODE_0;
+        break;
+    }
+
+    snprintf(path, sizeof(path), MYNEWT_VAL(DW3000_HAL_SPIDEV_PATH), inst->spi_num, inst->ss_pin);
+    inst->spidev_fd = open(path, O_RDWR);
+    if (inst->spidev_fd < 0) {
+        return DPL_ENOENT;
+    }
+    if (ioctl(inst->spidev_fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+        ioctl(inst->spidev_fd, SPI_IOC_WR_LSB_FIRST, &lsb_first) < 0 ||
+        ioctl(inst->spidev_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+        ioctl(inst->spidev_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) {
+        hal_dw3000_spidev_close(inst);
+        return DPL_EINVAL;
+    }
+    return DPL_OK;
+}
+
+/**
+ * API to close the spidev device of an instance.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+hal_dw3000_spidev_close(struct _dw3000_dev_instance_t * inst)
+{
+    if (inst->spidev_fd >= 0) {
+        close(inst->spidev_fd);
+        inst->spidev_fd = -1;
+    }
+}
+
+/**
+ * Perform a transfer as one spidev message, the command header and the
+ * data are separate segments so neither needs to be copied. spidev keeps
+ * chip select asserted for the whole message.
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param cmd       Represents an array of masked attributes like reg,subindex,operation,extended,subaddress.
+ * @param cmd_size  Represents value based on the cmd attributes.
+ * @param buffer    Data to be sent on writes, results are stored here on reads.
+ * @param length    Represents buffer length.
+ * @param is_write  Non-zero for a write, zero for a read.
+ * @return int      DPL_OK if transfer is ok, error otherwise
+ */
+static int
+hal_dw3000_spidev_txrx(struct _dw3000_dev_instance_t * inst,
+                       const uint8_t * cmd, uint8_t cmd_size,
+                       uint8_t * buffer, uint16_t length, uint8_t is_write)
+{
+    int rc;
+    struct spi_ioc_transfer xfer[2];
+
+    if (inst->spidev_fd < 0) {
+        rc = hal_dw3000_spidev_open(inst);
+        if (rc != DPL_OK) {
+            inst->uwb_dev.status.spi_error = 1;
+            return rc;
+        }
+    }
+
+    memset(xfer, 0, sizeof(xfer));
+    /* Speed is set per message so baudrate changes need no reconfiguration */
+    xfer[0].tx_buf = (uintptr_t)cmd;
+    xfer[0].len = cmd_size;
+    xfer[0].speed_hz = inst->spi_settings.baudrate * 1000;
+    xfer[0].bits_per_word = 8;
+    xfer[1] = xfer[0];
+    /* A NULL tx_buf clocks out zeros */
+    xfer[1].tx_buf = (is_write) ? (uintptr_t)buffer : 0;
+    xfer[1].rx_buf = (is_write) ? 0 : (uintptr_t)buffer;
+    xfer[1].len = length;
+
+    if (length) {
+        rc = ioctl(inst->spidev_fd, SPI_IOC_MESSAGE(2), xfer);
+    } else {
+        rc = ioctl(inst->spidev_fd, SPI_IOC_MESSAGE(1), xfer);
+    }
+    if (rc < 0) {
+        inst->uwb_dev.status.spi_error = 1;
+        return DPL_EINVAL;
+    }
+    return DPL_OK;
+}
+#endif
+
+/**
+ * Perform a single blocking transfer with the spi bus already acquired.
+ * Chip select is asserted for the duration of the transfer.
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param cmd       Represents an array of masked attributes like reg,subindex,operation,extended,subaddress.
+ * @param cmd_size  Represents value based on the cmd attributes.
+ * @param buffer    Data to be sent on writes, results are stored here on reads.
+ * @param length    Represents buffer length.
+ * @param is_write  Non-zero for a write, zero for a read.
+ * @return int      DPL_OK if transfer is ok, error otherwise
+ */
+static int
+hal_dw3000_txrx_locked(struct _dw3000_dev_instance_t * inst,
+                       const uint8_t * cmd, uint8_t cmd_size,
+                       uint8_t * buffer, uint16_t length, uint8_t is_write)
+{
+    int rc;
+#if !defined(MYNEWT) && MYNEWT_VAL(DW3000_HAL_SPIDEV)
+    rc = hal_dw3000_spidev_txrx(inst, cmd, cmd_size, buffer, length, is_write);
+#else
+    hal_gpio_write(inst->ss_pin, 0);
+
+#if !defined(MYNEWT)
+    /* Linux mode really, for when we can't split the command and data */
+    assert(cmd_size + length < inst->uwb_dev.txbuf_size);
+    assert(cmd_size + length < MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT));
+
+    memcpy(inst->uwb_dev.txbuf, cmd, cmd_size);
+    if (is_write) {
+        memcpy(inst->uwb_dev.txbuf + cmd_size, buffer, length);
+        rc = hal_spi_txrx(inst->spi_num, inst->uwb_dev.txbuf,
+                          0, cmd_size+length);
+        assert(rc == DPL_OK);
+    } else {
+        memset(inst->uwb_dev.txbuf + cmd_size, 0, length);
+        rc = hal_spi_txrx(inst->spi_num, inst->uwb_dev.txbuf,
+                          inst->uwb_dev.txbuf, cmd_size+length);
+        memcpy(buffer, inst->uwb_dev.txbuf + cmd_size, length);
+    }
+#else
+    rc = hal_spi_txrx(inst->spi_num, (void*)cmd, 0, cmd_size);
+    assert(rc == DPL_OK);
+    if (is_write) {
+        if (length) {
+            hal_spi_txrx(inst->spi_num, (void*)buffer, 0, length);
+        }
+    } else {
+        int step = (inst->uwb_dev.txbuf_size > MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT)) ?
+            MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT) : inst->uwb_dev.txbuf_size;
+        int bytes_left = length;
+        for (int offset = 0;offset<length && rc == DPL_OK;offset+=step) {
+            int bytes_to_read = (bytes_left > step) ? step : bytes_left;
+            bytes_left-=bytes_to_read;
+            rc = hal_spi_txrx(inst->spi_num, inst->uwb_dev.txbuf, buffer+offset, bytes_to_read);
+        }
+    }
+#endif
+    hal_gpio_write(inst->ss_pin, 1);
+#endif
+    return rc;
+}
+
+#if MYNEWT_VAL(DW3000_SPI_WC_MAX)
+/**
+ * Write the pending combined burst of inst, with the spi bus acquired. The
+ * writes it holds have already returned to their callers, a failure is
+ * reported through status.spi_error.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return int  DPL_OK on success, error otherwise
+ */
+static int
+hal_dw3000_wc_flush_locked(struct _dw3000_dev_instance_t * inst)
+{
+    int rc;
+    uint16_t sub = inst->wc_sub;
+    uint16_t length = inst->wc_len;
+    uint8_t header[] = {
+        [0] = 1 << 7 | (sub != 0) << 6 | inst->wc_reg,
+        [1] = (sub > 0x7F) << 7 | (uint8_t) (sub),
+        [2] = (uint8_t) (sub >> 7)
+    };
+    uint8_t len = sub?((sub > 0x7F)?3:2):1;
+
+    inst->wc_len = 0;
+    DW3000_SPI_TRACE(inst, header, len, length, 1, 0);
+    rc = hal_dw3000_txrx_locked(inst, header, len, inst->wc_buf, length, 1);
+    DW3000_SPI_TRACE_END(inst);
+    if (rc != DPL_OK) {
+        inst->uwb_dev.status.spi_error = 1;
+    }
+    return rc;
+}
+
+/**
+ * API to write out the pending combined burst of inst, if any. A failed
+ * burst sets status.spi_error.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return int  DPL_OK on success, error otherwise
+ */
+int
+hal_dw3000_wc_flush(struct _dw3000_dev_instance_t * inst)
+{
+    int rc;
+    if (!inst->wc_len) {
+        return DPL_OK;
+    }
+    /* Acquiring the bus flushes the burst, errors are flagged in status.spi_error */
+    rc = hal_dw3000_bus_acquire(inst, hal_dw3000_spi_prio(inst));
+    if (rc != DPL_OK) {
+        inst->uwb_dev.status.sem_error = 1;
+        return rc;
+    }
+    rc = hal_dw3000_bus_release(inst);
+    assert(rc == DPL_OK);
+    return rc;
+}
+#endif
+
+/**
+ * API to perform a blocking read over SPI
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param cmd       Represents an array of masked attributes like reg,subindex,operation,extended,subaddress.
+ * @param cmd_size  Represents value based on the cmd attributes.
+ * @param buffer    Results are stored into the buffer.
+ * @param length    Represents buffer length.
+ * @return int      DPL_OK if read is ok, error otherwise
+ */
+int
+hal_dw3000_read(struct _dw3000_dev_instance_t * inst,
+                const uint8_t * cmd, uint8_t cmd_size,
+                uint8_t * buffer, uint16_t length)
+{
+    return hal_dw3000_read_prio(inst, hal_dw3000_spi_prio(inst), cmd, cmd_size, buffer, length);
+}
+
+/**
+ * API to perform a blocking read over SPI with a given bus arbitration class
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param prio      Arbitration class, see dw3000_spi_prio_t.
+ * @param cmd       Represents an array of masked attributes like reg,subindex,operation,extended,subaddress.
+ * @param cmd_size  Represents value based on the cmd attributes.
+ * @param buffer    Results are stored into the buffer.
+ * @param length    Represents buffer length.
+ * @return int      DPL_OK if read is ok, error otherwise
+ */
+int
+hal_dw3000_read_prio(struct _dw3000_dev_instance_t * inst, uint8_t prio,
+                     const uint8_t * cmd, uint8_t cmd_size,
+                     uint8_t * buffer, uint16_t length)
+{
+    int rc;
+    assert(inst->spi_sem);
+    rc = hal_dw3000_bus_acquire(inst, prio);
+    if (rc != DPL_OK) {
+        inst->uwb_dev.status.sem_error = 1;
+        goto early_exit;
+    }
+    DW3000_SPI_TRACE(inst, cmd, cmd_size, length, 0, 0);
+
+    hal_dw3000_txrx_locked(inst, cmd, cmd_size, buffer, length, 0);
+
+    DW3000_SPI_TRACE_END(inst);
+    rc = hal_dw3000_bus_release(inst);
+    assert(rc == DPL_OK);
+early_exit:
+    return rc;
+}
+
+
+#if MYNEWT_VAL(DW3000_HAL_SPI_ASYNC)
+/**
+ * Start the first phase (the command) of an asynchronous transfer.
+ * Called with the spi bus acquired.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param x     Pointer to dw3000_spi_async_t.
+ * @return int  DPL_OK if the transfer was started ok, error otherwise
+ */
+static int
+hal_dw3000_async_start(struct _dw3000_dev_instance_t * inst, dw3000_spi_async_t * x)
+{
+    assert(x->cmd_size <= sizeof(inst->spi_cmd_rx));
+    x->offset = 0;
+    x->chunk = 0;
+    x->cmd_done = 0;
+    DW3000_SPI_TRACE(inst, x->cmd, x->cmd_size, x->length, x->is_write, 1);
+
+    hal_gpio_write(inst->ss_pin, 0);
+    return hal_spi_txrx_noblock(inst->spi_num, x->cmd, inst->spi_cmd_rx, x->cmd_size);
+}
 
 /**
- * API to choose DW3000 instances based on parameters.
+ * Complete the asynchronous transfer at the head of the queue, call its
+ * callback and start the next queued transfer, if any. Releases the spi bus
+ * once the queue is empty. Interrupt context.
  *
- * @param idx  Indicates number of instances for the chosen bsp.
- * @return dw3000_dev_instance_t
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param rc    Result of the transfer being completed.
+ * @return void
  */
-
-struct _dw3000_dev_instance_t *
-hal_dw3000_inst(uint8_t idx)
+static void
+hal_dw3000_async_complete(struct _dw3000_dev_instance_t * inst, int rc)
 {
-    if (idx < ARRAY_SIZE(hal_dw3000_instances)) {
-        return &hal_dw3000_instances[idx];
+    dpl_error_t err;
+    os_sr_t sr;
+    dw3000_spi_async_t * x;
+
+    do {
+        hal_gpio_write(inst->ss_pin, 1);
+        DW3000_SPI_TRACE_END(inst);
+
+        /* Keep the transfer at the head while its callback runs so that
+         * transfers submitted from the callback are queued behind it */
+        x = inst->async_head;
+        if (x->cb) {
+            x->cb(inst, x->cb_arg, rc);
+        }
+        DPL_ENTER_CRITICAL(sr);
+        inst->async_head = x->next;
+        if (inst->async_head == NULL) {
+            inst->async_tail = NULL;
+        }
+        DPL_EXIT_CRITICAL(sr);
+        if (inst->async_head == NULL) {
+            break;
+        }
+        rc = hal_dw3000_async_start(inst, inst->async_head);
+    } while (rc != DPL_OK);
+
+    if (inst->async_head == NULL) {
+        err = hal_dw3000_bus_release(inst);
+        assert(err == DPL_OK);
     }
-    return 0;
 }
 
 /**
- * API to reset all the gpio pins.
+ * Start the next chunk of the asynchronous transfer at the head of the
+ * queue, or complete it if all data has been transferred. Interrupt context.
  *
  * @param inst  Pointer to dw3000_dev_instance_t.
  * @return void
  */
-void
-hal_dw3000_reset(struct _dw3000_dev_instance_t * inst)
+static void
+hal_dw3000_async_continue(struct _dw3000_dev_instance_t * inst)
 {
-    assert(inst);
+    int rc;
+    dw3000_spi_async_t * x = inst->async_head;
 
-    hal_gpio_init_out(inst->ss_pin, 1);
-    hal_gpio_init_out(inst->rst_pin, 0);
+    if (x->cmd_done) {
+        x->offset += x->chunk;
+    }
+    x->cmd_done = 1;
 
-    hal_gpio_write(inst->rst_pin, 0);
-    dpl_cputime_delay_usecs(1);
-    hal_gpio_write(inst->rst_pin, 1);
-    hal_gpio_init_in(inst->rst_pin, HAL_GPIO_PULL_NONE);
+    if (x->offset >= x->length) {
+        hal_dw3000_async_complete(inst, DPL_OK);
+        return;
+    }
 
-    dpl_cputime_delay_usecs(5000);
+    if (x->is_write) {
+        /* The txbuf is only used as a sink for whatever comes back on MISO */
+        int step = (inst->uwb_dev.txbuf_size > MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT)) ?
+            MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT) : inst->uwb_dev.txbuf_size;
+        x->chunk = (x->length - x->offset > step) ? step : x->length - x->offset;
+        rc = hal_spi_txrx_noblock(inst->spi_num, x->buffer + x->offset,
+                                  inst->uwb_dev.txbuf, x->chunk);
+    } else {
+        x->chunk = (x->length - x->offset > MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT)) ?
+            MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT) : x->length - x->offset;
+        rc = hal_spi_txrx_noblock(inst->spi_num, hal_dw3000_zero_tx,
+                                  x->buffer + x->offset, x->chunk);
+    }
+    if (rc != DPL_OK) {
+        hal_dw3000_async_complete(inst, rc);
+    }
 }
 
 /**
- * API to perform a blocking read over SPI
+ * API to submit an asynchronous transfer. The call only blocks until the
+ * spi bus is available, the transfer itself is driven from the spi interrupt
+ * and xfer->cb is called, in interrupt context, once it has completed.
+ * Transfers submitted while another asynchronous transfer is in progress on
+ * the same instance are queued and started in order without releasing the bus.
+ * Use hal_dw3000_rw_noblock_wait to wait for all queued transfers.
+ * A transfer descriptor may not be resubmitted from its own callback.
  *
- * @param inst      Pointer to dw3000_dev_instance_t.
- * @param cmd       Represents an array of masked attributes like reg,subindex,operation,extended,subaddress.
- * @param cmd_size  Represents value based on the cmd attributes.
- * @param buffer    Results are stored into the buffer.
- * @param length    Represents buffer length.
- * @return int      DPL_OK if read is ok, error otherwise
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param xfer  Pointer to dw3000_spi_async_t, must remain valid until completed.
+ * @return int  DPL_OK if the transfer was queued ok, error otherwise
  */
 int
-hal_dw3000_read(struct _dw3000_dev_instance_t * inst,
-                const uint8_t * cmd, uint8_t cmd_size,
-                uint8_t * buffer, uint16_t length)
+hal_dw3000_async_submit(struct _dw3000_dev_instance_t * inst, dw3000_spi_async_t * xfer)
 {
     int rc;
+    os_sr_t sr;
     assert(inst->spi_sem);
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    xfer->next = NULL;
+
+    DPL_ENTER_CRITICAL(sr);
+    if (inst->async_head) {
+        inst->async_tail->next = xfer;
+        inst->async_tail = xfer;
+        DPL_EXIT_CRITICAL(sr);
+        return DPL_OK;
+    }
+    DPL_EXIT_CRITICAL(sr);
+
+    rc = hal_dw3000_bus_acquire(inst, hal_dw3000_spi_prio(inst));
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
-        goto early_exit;
+        if (xfer->cb) {
+            xfer->cb(inst, xfer->cb_arg, rc);
+        }
+        return rc;
     }
-    DW3000_SPI_BT_ADD(inst, cmd, cmd_size, buffer, length, 0, 0);
 
-    hal_gpio_write(inst->ss_pin, 0);
+    /* Only publish the head once the bus is owned, until then completions
+     * belong to whichever nonblocking transfer is still in flight */
+    DPL_ENTER_CRITICAL(sr);
+    inst->async_head = inst->async_tail = xfer;
+    DPL_EXIT_CRITICAL(sr);
 
-#if !defined(MYNEWT)
-    /* Linux mode really, for when we can't split the command and data */
-    assert(cmd_size + length < inst->uwb_dev.txbuf_size);
-    assert(cmd_size + length < MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT));
+    /* Route the completion of this transfer to inst */
+    rc = hal_dw3000_spi_claim(inst);
+    if (rc == DPL_OK) {
+        rc = hal_dw3000_async_start(inst, xfer);
+    }
+    if (rc != DPL_OK) {
+        /* Fails this and any transfers queued meanwhile, releases the bus */
+        hal_dw3000_async_complete(inst, rc);
+    }
+    return rc;
+}
 
-    memcpy(inst->uwb_dev.txbuf, cmd, cmd_size);
-    memset(inst->uwb_dev.txbuf + cmd_size, 0, length);
+/**
+ * API to start a chain of asynchronous transfers without blocking, usable from
+ * interrupt context. Fails instead of waiting if the spi bus is taken, if another
+ * asynchronous transfer is in progress or if a combined write is pending. As the
+ * spi driver can't be reconfigured from interrupt context it also fails unless the
+ * bus is already set up for inst, the bus is only tried with a zero timeout.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param xfer  First of a chain of dw3000_spi_async_t linked through next.
+ * @return int  DPL_OK if the chain was accepted, its callbacks are then always called
+ */
+int
+hal_dw3000_async_try_submit(struct _dw3000_dev_instance_t * inst, dw3000_spi_async_t * xfer)
+{
+    int rc;
+    os_sr_t sr;
+    dw3000_spi_async_t * last = xfer;
+    struct hal_dw3000_spi_bus * bus = hal_dw3000_spi_bus_get(inst);
+    assert(inst->spi_sem);
 
-    rc = hal_spi_txrx(inst->spi_num, inst->uwb_dev.txbuf,
-                      inst->uwb_dev.txbuf, cmd_size+length);
-    memcpy(buffer, inst->uwb_dev.txbuf + cmd_size, length);
-#else
-    rc = hal_spi_txrx(inst->spi_num, (void*)cmd, 0, cmd_size);
-    assert(rc == DPL_OK);
-    int step = (inst->uwb_dev.txbuf_size > MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT)) ?
-        MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT) : inst->uwb_dev.txbuf_size;
-    int bytes_left = length;
-    for (int offset = 0;offset<length && rc == DPL_OK;offset+=step) {
-        int bytes_to_read = (bytes_left > step) ? step : bytes_left;
-        bytes_left-=bytes_to_read;
-        rc = hal_spi_txrx(inst->spi_num, inst->uwb_dev.txbuf, buffer+offset, bytes_to_read);
+    while (last->next) {
+        last = last->next;
+    }
+
+    /* Never wait from interrupt context, take the bus only if nobody has it */
+    DPL_ENTER_CRITICAL(sr);
+    if (bus->busy) {
+        DPL_EXIT_CRITICAL(sr);
+        return DPL_EBUSY;
+    }
+    bus->busy = 1;
+    DPL_EXIT_CRITICAL(sr);
+    rc = dpl_sem_pend(inst->spi_sem, 0);
+    if (rc != DPL_OK) {
+        hal_dw3000_bus_grant(bus);
+        return rc;
     }
+    DPL_ENTER_CRITICAL(sr);
+#if MYNEWT_VAL(DW3000_SPI_WC_MAX)
+    if (inst->async_head || inst->wc_len ||
+#else
+    if (inst->async_head ||
 #endif
-    hal_gpio_write(inst->ss_pin, 1);
+        !bus->bound || !hal_dw3000_spi_clk_synced(inst, bus)) {
+        DPL_EXIT_CRITICAL(sr);
+        rc = hal_dw3000_bus_release(inst);
+        assert(rc == DPL_OK);
+        return DPL_EBUSY;
+    }
+    inst->async_head = xfer;
+    inst->async_tail = last;
+    bus->owner = inst;
+    DPL_EXIT_CRITICAL(sr);
 
-    DW3000_SPI_BT_ADD_END(inst);
-    rc = dpl_sem_release(inst->spi_sem);
-    assert(rc == DPL_OK);
-early_exit:
-    return rc;
+    rc = hal_dw3000_async_start(inst, xfer);
+    if (rc != DPL_OK) {
+        /* Fails the chain, releases the bus */
+        hal_dw3000_async_complete(inst, rc);
+    }
+    return DPL_OK;
 }
-
+#endif
 
 /**
  * Interrupt context callback for nonblocking SPI-functions
@@ -356,19 +1117,104 @@ hal_dw3000_spi_txrx_cb(void *arg, int len)
     struct _dw3000_dev_instance_t * inst = arg;
     assert(inst!=0);
 
+#if MYNEWT_VAL(DW3000_HAL_SPI_ASYNC)
+    /* Asynchronous transfers hold the bus, nothing else can be in flight */
+    if (inst->async_head) {
+        hal_dw3000_async_continue(inst);
+        return;
+    }
+#endif
+
     /* Check for longer nonblocking read/write op */
     if (dpl_sem_get_count(&inst->spi_nb_sem) == 0) {
         err = dpl_sem_release(&inst->spi_nb_sem);
         assert(err == DPL_OK);
     } else {
         hal_gpio_write(inst->ss_pin, 1);
-        DW3000_SPI_BT_ADD_END(inst);
-        err = dpl_sem_release(inst->spi_sem);
+        DW3000_SPI_TRACE_END(inst);
+        err = hal_dw3000_bus_release(inst);
         assert(err == DPL_OK);
     }
 }
 
 
+#if MYNEWT_VAL(DW3000_HAL_SPI_ZERO_COPY_MIN) && (defined(MYNEWT) || !MYNEWT_VAL(DW3000_HAL_SPIDEV))
+/**
+ * Zero-copy part of a non-blocking read. The command is sent directly from
+ * cmd and the response is DMA'd straight into buffer in chunks of at most
+ * DW3000_HAL_SPI_MAX_CNT bytes, without touching inst->uwb_dev.txbuf.
+ * Must be called with the spi bus acquired and ss low. The final chunk
+ * completes in hal_dw3000_spi_txrx_cb which releases the bus.
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param cmd       Represents an array of masked attributes like reg,subindex,operation,extended,subaddress.
+ * @param cmd_size  Represents value based on the cmd attributes.
+ * @param buffer    Results are stored into the buffer.
+ * @param length    Represents buffer length.
+ * @return int      DPL_OK if the transfer was started ok, error otherwise
+ */
+static int
+hal_dw3000_read_zero_copy(struct _dw3000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length)
+{
+    int rc;
+    int offset = 0;
+    int bytes_left = length;
+    assert(cmd_size <= sizeof(inst->spi_cmd_rx));
+
+    rc = dpl_sem_pend(&inst->spi_nb_sem, DPL_TIMEOUT_NEVER);
+    if (rc != DPL_OK) {
+        inst->uwb_dev.status.sem_error = 1;
+        return rc;
+    }
+
+    /* Send command portion */
+    rc = hal_spi_txrx_noblock(inst->spi_num, (void*)cmd, inst->spi_cmd_rx, cmd_size);
+    if (rc != DPL_OK) {
+        return rc;
+    }
+
+    /* Wait for command to send */
+    rc = dpl_sem_pend(&inst->spi_nb_sem, DPL_TIMEOUT_NEVER);
+    if (rc != DPL_OK) {
+        inst->uwb_dev.status.sem_error = 1;
+        return rc;
+    }
+    rc = dpl_sem_release(&inst->spi_nb_sem);
+    assert(rc == DPL_OK);
+
+    while (offset<length) {
+        int bytes_to_read = (bytes_left > MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT)) ?
+            MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT) : bytes_left;
+        bytes_left-=bytes_to_read;
+
+        /* Only use the spi_nb_sem if needed */
+        if (bytes_left) {
+            rc = dpl_sem_pend(&inst->spi_nb_sem, DPL_TIMEOUT_NEVER);
+            if (rc != DPL_OK) {
+                inst->uwb_dev.status.sem_error = 1;
+                return rc;
+            }
+        }
+        rc = hal_spi_txrx_noblock(inst->spi_num, hal_dw3000_zero_tx,
+                                  buffer+offset, bytes_to_read);
+        assert(rc==DPL_OK);
+
+        /* Only wait for this round if there is more data to read */
+        if (bytes_left) {
+            rc = dpl_sem_pend(&inst->spi_nb_sem, DPL_TIMEOUT_NEVER);
+            if (rc != DPL_OK) {
+                inst->uwb_dev.status.sem_error = 1;
+                return rc;
+            }
+            rc = dpl_sem_release(&inst->spi_nb_sem);
+            assert(rc == DPL_OK);
+        }
+        offset+=bytes_to_read;
+    }
+    return rc;
+}
+#endif
+
 /**
  * API to perform a non-blocking read from SPI
  *
@@ -382,27 +1228,57 @@ hal_dw3000_spi_txrx_cb(void *arg, int len)
 int
 hal_dw3000_read_noblock(struct _dw3000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length)
 {
+    return hal_dw3000_read_noblock_prio(inst, hal_dw3000_spi_prio(inst), cmd, cmd_size, buffer, length);
+}
+
+/**
+ * API to perform a non-blocking read from SPI with a given bus arbitration class
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param prio      Arbitration class, see dw3000_spi_prio_t.
+ * @param cmd       Represents an array of masked attributes like reg,subindex,operation,extended,subaddress.
+ * @param cmd_size  Represents value based on the cmd attributes.
+ * @param buffer    Results are stored into the buffer.
+ * @param length    Represents buffer length.
+ * @return int      DPL_OK if read is ok, error otherwise
+ */
+int
+hal_dw3000_read_noblock_prio(struct _dw3000_dev_instance_t * inst, uint8_t prio,
+                             const uint8_t * cmd, uint8_t cmd_size,
+                             uint8_t * buffer, uint16_t length)
+{
+#if !defined(MYNEWT) && MYNEWT_VAL(DW3000_HAL_SPIDEV)
+    /* spidev messages are synchronous, nothing to gain from splitting */
+    return hal_dw3000_read_prio(inst, prio, cmd, cmd_size, buffer, length);
+#else
     int rc = DPL_OK;
     assert(inst->spi_sem);
 
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    rc = hal_dw3000_bus_acquire(inst, prio);
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
         goto early_exit;
     }
-    DW3000_SPI_BT_ADD(inst, cmd, cmd_size, buffer, length, 0, 1);
+    DW3000_SPI_TRACE(inst, cmd, cmd_size, length, 0, 1);
 
-    /* Reset the txrx_cb to make sure it has the correct instance
-     * as argument */
-    rc = hal_spi_disable(inst->spi_num);
-    rc |= hal_spi_set_txrx_cb(inst->spi_num, hal_dw3000_spi_txrx_cb, (void*)inst);
-    rc |= hal_spi_enable(inst->spi_num);
+    /* Route the completion of this transfer to inst */
+    rc = hal_dw3000_spi_claim(inst);
     if (rc != DPL_OK) {
         goto err_return;
     }
 
     hal_gpio_write(inst->ss_pin, 0);
 
+#if MYNEWT_VAL(DW3000_HAL_SPI_ZERO_COPY_MIN)
+    if (length >= MYNEWT_VAL(DW3000_HAL_SPI_ZERO_COPY_MIN)) {
+        rc = hal_dw3000_read_zero_copy(inst, cmd, cmd_size, buffer, length);
+        if (rc != DPL_OK) {
+            goto err_return;
+        }
+        goto wait_complete;
+    }
+#endif
+
     /* Faster read for shorter exchanges */
     if (cmd_size + length < inst->uwb_dev.txbuf_size &&
         cmd_size + length < MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT)) {
@@ -428,8 +1304,8 @@ hal_dw3000_read_noblock(struct _dw3000_dev_instance_t * inst, const uint8_t * cm
         hal_gpio_write(inst->ss_pin, 1);
 
         memcpy(buffer, inst->uwb_dev.txbuf + cmd_size, length);
-        DW3000_SPI_BT_ADD_END(inst);
-        rc = dpl_sem_release(inst->spi_sem);
+        DW3000_SPI_TRACE_END(inst);
+        rc = hal_dw3000_bus_release(inst);
         assert(rc == DPL_OK);
         return rc;
     }
@@ -493,23 +1369,31 @@ hal_dw3000_read_noblock(struct _dw3000_dev_instance_t * inst, const uint8_t * cm
         }
         offset+=bytes_to_read;
     }
+#else
+    assert(0);
+#endif
 
-    /* Reaquire semaphore after rx complete */
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+#if MYNEWT_VAL(DW3000_HAL_SPI_ZERO_COPY_MIN)
+wait_complete:
+#endif
+#if MYNEWT_VAL(DW3000_HAL_SPI_ZERO_COPY_MIN) || \
+    MYNEWT_VAL(DW3000_HAL_SPI_BUFFER_SIZE) < 1024 || MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT) < 1028
+    /* The last chunk completes in hal_dw3000_spi_txrx_cb, which releases
+     * the bus, wait for it */
+    rc = hal_dw3000_rw_noblock_wait(inst, DPL_TIMEOUT_NEVER);
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
-        goto err_return;
     }
-
-#else
-    assert(0);
+    goto early_exit;
 #endif
+
 err_return:
-    rc = dpl_sem_release(inst->spi_sem);
+    rc = hal_dw3000_bus_release(inst);
     assert(rc == DPL_OK);
 
 early_exit:
     return rc;
+#endif
 }
 
 
@@ -528,38 +1412,17 @@ hal_dw3000_write(struct _dw3000_dev_instance_t * inst, const uint8_t * cmd, uint
 {
     int rc = DPL_OK;
     assert(inst->spi_sem);
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    rc = hal_dw3000_bus_acquire(inst, hal_dw3000_spi_prio(inst));
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
         goto early_exit;
     }
-    DW3000_SPI_BT_ADD(inst, cmd, cmd_size, buffer, length, 1, 0);
-
-    hal_gpio_write(inst->ss_pin, 0);
-
-#if !defined(MYNEWT)
-    /* Linux mode really, for when we can't split the command and data */
-    assert(cmd_size + length < inst->uwb_dev.txbuf_size);
-    assert(cmd_size + length < MYNEWT_VAL(DW3000_HAL_SPI_MAX_CNT));
-
-    memcpy(inst->uwb_dev.txbuf, cmd, cmd_size);
-    memcpy(inst->uwb_dev.txbuf+cmd_size, buffer, length);
-
-    rc = hal_spi_txrx(inst->spi_num, inst->uwb_dev.txbuf,
-                      0, cmd_size+length);
-    assert(rc == DPL_OK);
-#else
-    rc = hal_spi_txrx(inst->spi_num, (void*)cmd, 0, cmd_size);
-    assert(rc == DPL_OK);
-    if (length) {
-        hal_spi_txrx(inst->spi_num, (void*)buffer, 0, length);
-    }
-#endif
+    DW3000_SPI_TRACE(inst, cmd, cmd_size, length, 1, 0);
 
-    hal_gpio_write(inst->ss_pin, 1);
+    hal_dw3000_txrx_locked(inst, cmd, cmd_size, buffer, length, 1);
 
-    DW3000_SPI_BT_ADD_END(inst);
-    rc = dpl_sem_release(inst->spi_sem);
+    DW3000_SPI_TRACE_END(inst);
+    rc = hal_dw3000_bus_release(inst);
     assert(rc == DPL_OK);
 early_exit:
     return rc;
@@ -579,21 +1442,22 @@ early_exit:
 int
 hal_dw3000_write_noblock(struct _dw3000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length)
 {
+#if !defined(MYNEWT) && MYNEWT_VAL(DW3000_HAL_SPIDEV)
+    /* spidev messages are synchronous, nothing to gain from splitting */
+    return hal_dw3000_write(inst, cmd, cmd_size, buffer, length);
+#else
     int rc = DPL_OK;
     assert(length);
     assert(inst->spi_sem);
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    rc = hal_dw3000_bus_acquire(inst, hal_dw3000_spi_prio(inst));
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
         goto early_exit;
     }
-    DW3000_SPI_BT_ADD(inst, cmd, cmd_size, buffer, length, 1, 1);
+    DW3000_SPI_TRACE(inst, cmd, cmd_size, length, 1, 1);
 
-    /* Reset the txrx_cb to make sure it has the correct instance
-     * as argument */
-    rc = hal_spi_disable(inst->spi_num);
-    rc |= hal_spi_set_txrx_cb(inst->spi_num, hal_dw3000_spi_txrx_cb, (void*)inst);
-    rc |= hal_spi_enable(inst->spi_num);
+    /* Route the completion of this transfer to inst */
+    rc = hal_dw3000_spi_claim(inst);
     if (rc != DPL_OK) {
         goto err_return;
     }
@@ -673,9 +1537,48 @@ early_exit:
     return rc;
 
 err_return:
-    rc = dpl_sem_release(inst->spi_sem);
+    rc = hal_dw3000_bus_release(inst);
     assert(rc == DPL_OK);
     return rc;
+#endif
+}
+
+/**
+ * API to perform a batch of blocking transfers over SPI. The bus is
+ * acquired once and each transfer gets its own chip select cycle,
+ * issued back to back in the order given.
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param xfers     Array of transfers.
+ * @param count     Number of transfers in xfers.
+ * @return int      DPL_OK if all transfers are ok, error otherwise
+ */
+int
+hal_dw3000_batch(struct _dw3000_dev_instance_t * inst, dw3000_spi_xfer_t * xfers, uint8_t count)
+{
+    int rc = DPL_OK;
+    dpl_error_t err;
+    assert(inst->spi_sem);
+    if (!count) {
+        return rc;
+    }
+    rc = hal_dw3000_bus_acquire(inst, hal_dw3000_spi_prio(inst));
+    if (rc != DPL_OK) {
+        inst->uwb_dev.status.sem_error = 1;
+        goto early_exit;
+    }
+
+    for (int i = 0;i < count;i++) {
+        dw3000_spi_xfer_t * x = &xfers[i];
+        DW3000_SPI_TRACE(inst, x->cmd, x->cmd_size, x->length, x->is_write, 0);
+        rc |= hal_dw3000_txrx_locked(inst, x->cmd, x->cmd_size, x->buffer, x->length, x->is_write);
+        DW3000_SPI_TRACE_END(inst);
+    }
+
+    err = hal_dw3000_bus_release(inst);
+    assert(err == DPL_OK);
+early_exit:
+    return rc;
 }
 
 /**
@@ -715,7 +1618,7 @@ hal_dw3000_wakeup(struct _dw3000_dev_instance_t * inst)
     int rc = DPL_OK;
     os_sr_t sr;
     assert(inst->spi_sem);
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    rc = hal_dw3000_bus_acquire(inst, hal_dw3000_spi_prio(inst));
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
         goto early_exit;
@@ -738,7 +1641,7 @@ hal_dw3000_wakeup(struct _dw3000_dev_instance_t * inst)
 
     DPL_EXIT_CRITICAL(sr);
 
-    rc = dpl_sem_release(inst->spi_sem);
+    rc = hal_dw3000_bus_release(inst);
     assert(rc == DPL_OK);
 early_exit:
     return rc;
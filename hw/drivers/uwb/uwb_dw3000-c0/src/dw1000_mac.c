@@ -42,6 +42,7 @@
 #include <dw3000-c0/dw3000_regs.h>
 #include <dw3000-c0/dw3000_dev.h>
 #include <dw3000-c0/dw3000_hal.h>
+#include <dw3000-c0/dw3000_regs_access.h>
 #include <dw3000-c0/dw3000_phy.h>
 #include <dw3000-c0/dw3000_stats.h>
 #include <dw3000-c0/dw3000_mac.h>
@@ -59,6 +60,23 @@ STATS_NAME_START(mac_stat_section)
     STATS_NAME(mac_stat_section, RX_err)
     STATS_NAME(mac_stat_section, TXBUF_err)
     STATS_NAME(mac_stat_section, PLL_LL_err)
+    STATS_NAME(mac_stat_section, SPI_nb_thr)
+    STATS_NAME(mac_stat_section, SPI_wv_err)
+    STATS_NAME(mac_stat_section, SPI_wv_retry)
+    STATS_NAME(mac_stat_section, SPI_wv_fallback)
+    STATS_NAME(mac_stat_section, SPI_wv_stepup)
+    STATS_NAME(mac_stat_section, PRF_hop_cnt)
+    STATS_NAME(mac_stat_section, PRF_hop_usec)
+    STATS_NAME(mac_stat_section, PRF_hop_max)
+    STATS_NAME(mac_stat_section, RXR_hwm)
+    STATS_NAME(mac_stat_section, RXR_drop)
+    STATS_NAME(mac_stat_section, RXD_hit)
+    STATS_NAME(mac_stat_section, RXD_miss)
+    STATS_NAME(mac_stat_section, POLL_enter)
+    STATS_NAME(mac_stat_section, POLL_drain)
+    STATS_NAME(mac_stat_section, RXL_skip_bytes)
+    STATS_NAME(mac_stat_section, RXF_accept)
+    STATS_NAME(mac_stat_section, RXF_reject)
 STATS_NAME_END(mac_stat_section)
 
 #define MAC_STATS_INC(__X) STATS_INC(inst->stat, __X)
@@ -215,35 +233,52 @@ static const uint16_t lde_replicaCoeff[] =
     LDE_REPC_PCODE_24
 };
 
+//! SYS_CFG bits set by dw3000_mac_config
+#define DW3000_MAC_SYS_CFG_BITS (SYS_CFG_RXM110K | SYS_CFG_PHR_MODE_11 | SYS_CFG_RXAUTR | SYS_CFG_DIS_DRXB)
+
+//! Register values derived from a mac configuration, see dw3000_mac_regs
+typedef struct _dw3000_mac_regs_t{
+    uint32_t sys_cfg;           //!< SYS_CFG, only DW3000_MAC_SYS_CFG_BITS
+    uint16_t lde_repc;          //!< LDE_REPC replica avoidance coefficient
+    uint8_t lde_cfg1;           //!< LDE_CFG1, see dw3000_phy_lde_params
+    uint16_t lde_cfg2;          //!< LDE_CFG2 tuning for the prf, see dw3000_phy_lde_params
+    uint32_t fs_pllcfg;         //!< FS_PLLCFG
+    uint8_t fs_plltune;         //!< FS_PLLTUNE
+    uint8_t rf_rxctrlh;         //!< RF_RXCTRLH
+    uint32_t rf_txctrl;         //!< RF_TXCTRL
+    uint16_t drx_tune0b;        //!< DRX_TUNE0b, sfd threshold
+    uint16_t drx_tune1a;        //!< DRX_TUNE1a
+    uint16_t drx_tune1b;        //!< DRX_TUNE1b
+    uint32_t drx_tune2;         //!< DRX_TUNE2
+    uint16_t drx_tune4h;        //!< DRX_TUNE4H, 0 if left unchanged
+    uint16_t drx_sfdtoc;        //!< DRX_SFDTOC
+    uint32_t agc_tune2;         //!< AGC_TUNE2
+    uint16_t agc_tune1;         //!< AGC_TUNE1
+    uint8_t usr_sfd;            //!< USR_SFD length, 0 if left unchanged
+    uint32_t chan_ctrl;         //!< CHAN_CTRL
+    uint32_t tx_fctrl;          //!< TX_FCTRL preamble length, prf and data rate
+} dw3000_mac_regs_t;
+
 /**
- * API to configure the mac layer in dw3000
- * @param inst     Pointer to _dw3000_dev_instance_t.
- * @param config   Pointer to dw3000_dev_config_t.
- * @return struct uwb_dev_status
+ * Translate a mac configuration into register values using the
+ * configuration tables above.
  *
+ * @param config   Pointer to dw3000_dev_config_t, a zero sfdTimeout is replaced by the default.
+ * @param regs     Register values.
+ * @return void
  */
-struct uwb_dev_status
-dw3000_mac_config(struct _dw3000_dev_instance_t * inst,
-                  struct uwb_dev_config * config)
+static void
+dw3000_mac_regs(struct uwb_dev_config * config, dw3000_mac_regs_t * regs)
 {
     uint8_t nsSfd_result  = 0;
     uint8_t useDWnsSFD = 0;
     uint8_t chan;
     uint8_t prfIndex;
     uint8_t bw;
-    uint16_t reg16;
-    uint32_t regval;
-
-    if (config == NULL) {
-        config = &inst->uwb_dev.config;
-    } else {
-        memcpy(&inst->uwb_dev.config, config, sizeof(struct uwb_dev_config));
-    }
 
     chan = config->channel;
     prfIndex = config->prf - DWT_PRF_16M;
     bw = ((chan == 4) || (chan == 7)) ? 1 : 0 ; // Select wide or narrow band
-    reg16 = lde_replicaCoeff[config->rx.preambleCodeIndex];
 
 #ifdef DW3000_API_ERROR_CHECK
     assert(config->dataRate <= DWT_BR_6M8);
@@ -269,86 +304,71 @@ dw3000_mac_config(struct _dw3000_dev_instance_t * inst,
 
     assert((config->rx.phrMode == DWT_PHRMODE_STD) || (config->rx.phrMode == DWT_PHRMODE_EXT));
 #endif
-    /* Read sysconfig register */
-    inst->sys_cfg_reg = SYS_CFG_MASK & dw3000_read_reg(inst, SYS_CFG_ID, 0, sizeof(uint32_t));
+    regs->lde_repc = lde_replicaCoeff[config->rx.preambleCodeIndex];
+    dw3000_phy_lde_params(prfIndex, &regs->lde_cfg1, &regs->lde_cfg2);
 
     /* For 110 kbps we need a special setup */
+    regs->sys_cfg = 0;
     if(config->dataRate == DWT_BR_110K){
-        inst->sys_cfg_reg |= SYS_CFG_RXM110K;
-        reg16 >>= 3; // lde_replicaCoeff must be divided by 8
-    }else{
-        inst->sys_cfg_reg &= (~SYS_CFG_RXM110K);
+        regs->sys_cfg |= SYS_CFG_RXM110K;
+        regs->lde_repc >>= 3; // lde_replicaCoeff must be divided by 8
     }
 
-    inst->sys_cfg_reg &= ~SYS_CFG_PHR_MODE_11;
-    inst->sys_cfg_reg |= (SYS_CFG_PHR_MODE_11 & (((uint32_t)config->rx.phrMode) << SYS_CFG_PHR_MODE_SHFT));
+    regs->sys_cfg |= (SYS_CFG_PHR_MODE_11 & (((uint32_t)config->rx.phrMode) << SYS_CFG_PHR_MODE_SHFT));
 
     if (config->rxauto_enable)
-        inst->sys_cfg_reg |=SYS_CFG_RXAUTR;
-    else
-        inst->sys_cfg_reg &= (~SYS_CFG_RXAUTR);
+        regs->sys_cfg |= SYS_CFG_RXAUTR;
 
     /* By default disable dbl-rxbuffer here and reenable later if needed */
-    inst->sys_cfg_reg |= SYS_CFG_DIS_DRXB;
-
-    dw3000_write_reg(inst, SYS_CFG_ID, 0, inst->sys_cfg_reg, sizeof(uint32_t));
-    /* Set the lde_replicaCoeff */
-    dw3000_write_reg(inst, LDE_IF_ID, LDE_REPC_OFFSET, reg16, sizeof(uint16_t));
-
-    dw3000_phy_config_lde(inst, prfIndex);
+    regs->sys_cfg |= SYS_CFG_DIS_DRXB;
 
     /* Configure PLL2/RF PLL block CFG/TUNE (for a given channel) */
-    dw3000_write_reg(inst, FS_CTRL_ID, FS_PLLCFG_OFFSET, fs_pll_cfg[chan_idx[chan]], sizeof(uint32_t));
-    dw3000_write_reg(inst, FS_CTRL_ID, FS_PLLTUNE_OFFSET, fs_pll_tune[chan_idx[chan]], sizeof(uint8_t));
+    regs->fs_pllcfg = fs_pll_cfg[chan_idx[chan]];
+    regs->fs_plltune = fs_pll_tune[chan_idx[chan]];
 
     /* Configure RF RX blocks (for specified channel/bandwidth) */
-    dw3000_write_reg(inst, RF_CONF_ID, RF_RXCTRLH_OFFSET, rx_config[bw], sizeof(uint8_t));
+    regs->rf_rxctrlh = rx_config[bw];
 
-    /* Configure RF TX blocks (for specified channel and PRF)
-     * Configure RF TX control */
-    dw3000_write_reg(inst, RF_CONF_ID, RF_TXCTRL_OFFSET, tx_config[chan_idx[chan]], sizeof(uint32_t));
+    /* Configure RF TX blocks (for specified channel and PRF) */
+    regs->rf_txctrl = tx_config[chan_idx[chan]];
 
     /* Configure the baseband parameters (for specified PRF, bit rate, PAC, and SFD settings) */
-    /* DTUNE0 */
-    dw3000_write_reg(inst, DRX_CONF_ID, DRX_TUNE0b_OFFSET, sftsh[config->dataRate][config->rx.sfdType], sizeof(uint16_t));
-    /* DTUNE1 */
-    dw3000_write_reg(inst, DRX_CONF_ID, DRX_TUNE1a_OFFSET, dtune1[prfIndex], sizeof(uint16_t));
+    regs->drx_tune0b = sftsh[config->dataRate][config->rx.sfdType];
+    regs->drx_tune1a = dtune1[prfIndex];
 
     if(config->dataRate == DWT_BR_110K){
-        dw3000_write_reg(inst, DRX_CONF_ID, DRX_TUNE1b_OFFSET, DRX_TUNE1b_110K, sizeof(uint16_t));
+        regs->drx_tune1b = DRX_TUNE1b_110K;
+        regs->drx_tune4h = 0;
     }else{
         if(config->tx.preambleLength == DWT_PLEN_64){
-            dw3000_write_reg(inst, DRX_CONF_ID, DRX_TUNE1b_OFFSET, DRX_TUNE1b_6M8_PRE64, sizeof(uint16_t));
-            dw3000_write_reg(inst, DRX_CONF_ID, DRX_TUNE4H_OFFSET, DRX_TUNE4H_PRE64, sizeof(uint16_t));
+            regs->drx_tune1b = DRX_TUNE1b_6M8_PRE64;
+            regs->drx_tune4h = DRX_TUNE4H_PRE64;
         }else{
-            dw3000_write_reg(inst, DRX_CONF_ID, DRX_TUNE1b_OFFSET, DRX_TUNE1b_850K_6M8, sizeof(uint16_t));
-            dw3000_write_reg(inst, DRX_CONF_ID, DRX_TUNE4H_OFFSET, DRX_TUNE4H_PRE128PLUS, sizeof(uint16_t));
+            regs->drx_tune1b = DRX_TUNE1b_850K_6M8;
+            regs->drx_tune4h = DRX_TUNE4H_PRE128PLUS;
         }
     }
-
-    /* DTUNE2 */
-    dw3000_write_reg(inst, DRX_CONF_ID, DRX_TUNE2_OFFSET,
-                     digital_bb_config[prfIndex][config->rx.pacLength], sizeof(uint32_t));
+    regs->drx_tune2 = digital_bb_config[prfIndex][config->rx.pacLength];
 
     /* DTUNE3 (SFD timeout) */
     /* Don't allow 0 - SFD timeout will always be enabled */
     if(config->rx.sfdTimeout == 0)
         config->rx.sfdTimeout= DWT_SFDTOC_DEF;
-
-    dw3000_write_reg(inst, DRX_CONF_ID, DRX_SFDTOC_OFFSET, config->rx.sfdTimeout, sizeof(uint16_t));
+    regs->drx_sfdtoc = config->rx.sfdTimeout;
 
     /* Configure AGC parameters */
-    dw3000_write_reg(inst, AGC_CTRL_ID, AGC_TUNE2_OFFSET, agc_config.lo32, sizeof(uint32_t));
-    dw3000_write_reg(inst, AGC_CTRL_ID, AGC_TUNE1_OFFSET, agc_config.target[prfIndex], sizeof(uint16_t));
+    regs->agc_tune2 = agc_config.lo32;
+    regs->agc_tune1 = agc_config.target[prfIndex];
 
     /* Set (non-standard) user SFD for improved performance, */
+    regs->usr_sfd = 0;
     if(config->rx.sfdType){
-        /* Write non standard (DW) SFD length */
-        dw3000_write_reg(inst, USR_SFD_ID, 0x0, dwnsSFDlen[config->dataRate], sizeof(uint8_t));
+        /* Non standard (DW) SFD length */
+        regs->usr_sfd = dwnsSFDlen[config->dataRate];
         nsSfd_result = 3 ;
         useDWnsSFD = 1 ;
     }
-    regval =  (CHAN_CTRL_TX_CHAN_MASK & (((uint32_t)chan) << CHAN_CTRL_TX_CHAN_SHIFT)) |                   // Transmit Channel
+    regs->chan_ctrl = (CHAN_CTRL_TX_CHAN_MASK & (((uint32_t)chan) << CHAN_CTRL_TX_CHAN_SHIFT)) |             // Transmit Channel
         (CHAN_CTRL_RX_CHAN_MASK & (((uint32_t)chan) << CHAN_CTRL_RX_CHAN_SHIFT)) |                         // Receive Channel
         (CHAN_CTRL_RXFPRF_MASK & (((uint32_t)config->prf) << CHAN_CTRL_RXFPRF_SHIFT)) |                    // RX PRF
         ((CHAN_CTRL_TNSSFD|CHAN_CTRL_RNSSFD) & (((uint32_t)nsSfd_result) << CHAN_CTRL_TNSSFD_SHIFT)) |     // nsSFD enable RX&TX
@@ -356,19 +376,77 @@ dw3000_mac_config(struct _dw3000_dev_instance_t * inst,
         (CHAN_CTRL_TX_PCOD_MASK & (((uint32_t)config->tx.preambleCodeIndex) << CHAN_CTRL_TX_PCOD_SHIFT)) | // TX Preamble Code
         (CHAN_CTRL_RX_PCOD_MASK & (((uint32_t)config->rx.preambleCodeIndex) << CHAN_CTRL_RX_PCOD_SHIFT)) ; // RX Preamble Code
 
-    dw3000_write_reg(inst, CHAN_CTRL_ID, 0, regval, sizeof(uint32_t)) ;
-
     /* Set up TX Preamble Size, PRF and Data Rate */
-    inst->tx_fctrl = (((uint32_t)(config->tx.preambleLength | config->prf)) << TX_FCTRL_TXPRF_SHFT) |
+    regs->tx_fctrl = (((uint32_t)(config->tx.preambleLength | config->prf)) << TX_FCTRL_TXPRF_SHFT) |
         (((uint32_t)config->dataRate) << TX_FCTRL_TXBR_SHFT);
+}
+
+/**
+ * API to configure the mac layer in dw3000
+ * @param inst     Pointer to _dw3000_dev_instance_t.
+ * @param config   Pointer to dw3000_dev_config_t.
+ * @return struct uwb_dev_status
+ *
+ */
+struct uwb_dev_status
+dw3000_mac_config(struct _dw3000_dev_instance_t * inst,
+                  struct uwb_dev_config * config)
+{
+    dw3000_mac_regs_t regs;
+
+    if (config == NULL) {
+        config = &inst->uwb_dev.config;
+    } else {
+        memcpy(&inst->uwb_dev.config, config, sizeof(struct uwb_dev_config));
+    }
+    dw3000_mac_regs(config, &regs);
+
+    /* Read sysconfig register */
+    inst->sys_cfg_reg = SYS_CFG_MASK & dw3000_read_reg_cached(inst, SYS_CFG_ID, 0, sizeof(uint32_t));
+    inst->sys_cfg_reg = (inst->sys_cfg_reg & ~DW3000_MAC_SYS_CFG_BITS) | regs.sys_cfg;
+
+    /* Only registers whose value changed since the last commit are written,
+     * neighbouring ones are merged into single bursts */
+    dw3000_wc_begin(inst);
+    dw3000_write_reg_diff(inst, SYS_CFG_ID, 0, inst->sys_cfg_reg, sizeof(uint32_t));
+    /* Set the lde_replicaCoeff */
+    dw3000_write_reg_diff(inst, LDE_IF_ID, LDE_REPC_OFFSET, regs.lde_repc, sizeof(uint16_t));
+
+    dw3000_phy_config_lde(inst, config->prf - DWT_PRF_16M);
+
+    dw3000_write_reg_diff(inst, FS_CTRL_ID, FS_PLLCFG_OFFSET, regs.fs_pllcfg, sizeof(uint32_t));
+    dw3000_write_reg_diff(inst, FS_CTRL_ID, FS_PLLTUNE_OFFSET, regs.fs_plltune, sizeof(uint8_t));
+    dw3000_write_reg_diff(inst, RF_CONF_ID, RF_RXCTRLH_OFFSET, regs.rf_rxctrlh, sizeof(uint8_t));
+    dw3000_write_reg_diff(inst, RF_CONF_ID, RF_TXCTRL_OFFSET, regs.rf_txctrl, sizeof(uint32_t));
+
+    dw3000_write_reg_diff(inst, DRX_CONF_ID, DRX_TUNE0b_OFFSET, regs.drx_tune0b, sizeof(uint16_t));
+    dw3000_write_reg_diff(inst, DRX_CONF_ID, DRX_TUNE1a_OFFSET, regs.drx_tune1a, sizeof(uint16_t));
+    dw3000_write_reg_diff(inst, DRX_CONF_ID, DRX_TUNE1b_OFFSET, regs.drx_tune1b, sizeof(uint16_t));
+    if (regs.drx_tune4h) {
+        dw3000_write_reg_diff(inst, DRX_CONF_ID, DRX_TUNE4H_OFFSET, regs.drx_tune4h, sizeof(uint16_t));
+    }
+    dw3000_write_reg_diff(inst, DRX_CONF_ID, DRX_TUNE2_OFFSET, regs.drx_tune2, sizeof(uint32_t));
+    dw3000_write_reg_diff(inst, DRX_CONF_ID, DRX_SFDTOC_OFFSET, regs.drx_sfdtoc, sizeof(uint16_t));
+
+    dw3000_write_reg_diff(inst, AGC_CTRL_ID, AGC_TUNE2_OFFSET, regs.agc_tune2, sizeof(uint32_t));
+    dw3000_write_reg_diff(inst, AGC_CTRL_ID, AGC_TUNE1_OFFSET, regs.agc_tune1, sizeof(uint16_t));
+
+    /* Write non standard (DW) SFD length */
+    if (regs.usr_sfd) {
+        dw3000_write_reg_diff(inst, USR_SFD_ID, 0x0, regs.usr_sfd, sizeof(uint8_t));
+    }
+    dw3000_write_reg_diff(inst, CHAN_CTRL_ID, 0, regs.chan_ctrl, sizeof(uint32_t)) ;
+
+    inst->tx_fctrl = regs.tx_fctrl;
     dw3000_write_reg(inst, TX_FCTRL_ID, 0, inst->tx_fctrl, sizeof(uint32_t));
+    dw3000_wc_end(inst);
     /* The SFD transmit pattern is initialised by the DW3000 upon a user TX request,
      * but (due to an IC issue) it is not done for an auto-ACK TX.
      * The SYS_CTRL write below works around this issue, by simultaneously initiating
      * and aborting a transmission, which correctly initialises the SFD
      * after its configuration or reconfiguration. */
     /* Request TX start and TRX off at the same time */
-    dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, SYS_CTRL_TXSTRT | SYS_CTRL_TRXOFF, sizeof(uint8_t));
+    dw3000_fast_cmd(inst, DW3000_FCMD_TX_TRXOFF);
 
     dw3000_mac_framefilter(inst, config->rx.frameFilter);
 
@@ -381,6 +459,174 @@ dw3000_mac_config(struct _dw3000_dev_instance_t * inst,
     return inst->uwb_dev.status;
 }
 
+#if MYNEWT_VAL(DW3000_MAC_PROFILES)
+//! SYS_CFG bits owned by a phy profile, the frame filter and double buffering are folded in
+#define DW3000_PROFILE_SYS_CFG_BITS (DW3000_MAC_SYS_CFG_BITS | SYS_CFG_FFE | SYS_CFG_FF_ALL_EN)
+
+/**
+ * API to precompile a mac configuration into a register image. The table lookups
+ * of dw3000_mac_config are done once here, dw3000_mac_profile_apply later writes
+ * the image without further computation. Nothing is written to the device.
+ *
+ * @param inst     Pointer to _dw3000_dev_instance_t.
+ * @param id       Profile id, less than DW3000_MAC_PROFILES.
+ * @param config   Pointer to dw3000_dev_config_t.
+ * @return int     DPL_OK, DPL_EINVAL if id is out of range
+ */
+int
+dw3000_mac_profile_compile(struct _dw3000_dev_instance_t * inst, uint8_t id, struct uwb_dev_config * config)
+{
+    dw3000_mac_profile_t * p;
+    dw3000_spi_xfer_t * x;
+    dw3000_mac_regs_t regs;
+    uint64_t val;
+
+    if (id >= MYNEWT_VAL(DW3000_MAC_PROFILES)) {
+        return DPL_EINVAL;
+    }
+    p = &inst->profiles[id];
+    memcpy(&p->config, config, sizeof(struct uwb_dev_config));
+    dw3000_mac_regs(&p->config, &regs);
+    if (p->config.rxauto_enable) {
+        assert(p->config.trxoff_enable);
+    }
+
+    p->sys_cfg = regs.sys_cfg;
+    if (p->config.rx.frameFilter) {
+        p->sys_cfg |= (p->config.rx.frameFilter & SYS_CFG_FF_ALL_EN) | SYS_CFG_FFE;
+    }
+    if (p->config.dblbuffon_enabled) {
+        p->sys_cfg &= ~SYS_CFG_DIS_DRXB;
+    }
+    p->tx_fctrl = regs.tx_fctrl;
+
+    /* Neighbouring sub-registers are merged into single bursts */
+    p->count = 0;
+    x = p->xfer;
+    /* SYS_CFG is completed with the bits not owned by the profile on apply */
+    dw3000_spi_xfer_init(x++, SYS_CFG_ID, 0, 1, NULL, sizeof(uint32_t));
+    dw3000_spi_xfer_init(x, LDE_IF_ID, LDE_REPC_OFFSET, 1, NULL, sizeof(uint16_t));
+    memcpy((x++)->data, &regs.lde_repc, sizeof(uint16_t));
+    dw3000_spi_xfer_init(x, LDE_IF_ID, LDE_CFG1_OFFSET, 1, NULL, sizeof(uint8_t));
+    (x++)->data[0] = regs.lde_cfg1;
+    dw3000_spi_xfer_init(x, LDE_IF_ID, LDE_CFG2_OFFSET, 1, NULL, sizeof(uint16_t));
+    memcpy((x++)->data, &regs.lde_cfg2, sizeof(uint16_t));
+
+    /* FS_PLLCFG and FS_PLLTUNE */
+    val = regs.fs_pllcfg | ((uint64_t)regs.fs_plltune << 32);
+    dw3000_spi_xfer_init(x, FS_CTRL_ID, FS_PLLCFG_OFFSET, 1, NULL, sizeof(uint32_t) + sizeof(uint8_t));
+    memcpy((x++)->data, &val, sizeof(uint64_t));
+    /* RF_RXCTRLH and RF_TXCTRL */
+    val = regs.rf_rxctrlh | ((uint64_t)regs.rf_txctrl << 8);
+    dw3000_spi_xfer_init(x, RF_CONF_ID, RF_RXCTRLH_OFFSET, 1, NULL, sizeof(uint8_t) + sizeof(uint32_t));
+    memcpy((x++)->data, &val, sizeof(uint64_t));
+
+    /* DRX_TUNE0b, DRX_TUNE1a, DRX_TUNE1b and DRX_TUNE2 */
+    memcpy(&p->drx_tune[DRX_TUNE0b_OFFSET - DRX_TUNE0b_OFFSET], &regs.drx_tune0b, sizeof(uint16_t));
+    memcpy(&p->drx_tune[DRX_TUNE1a_OFFSET - DRX_TUNE0b_OFFSET], &regs.drx_tune1a, sizeof(uint16_t));
+    memcpy(&p->drx_tune[DRX_TUNE1b_OFFSET - DRX_TUNE0b_OFFSET], &regs.drx_tune1b, sizeof(uint16_t));
+    memcpy(&p->drx_tune[DRX_TUNE2_OFFSET - DRX_TUNE0b_OFFSET], &regs.drx_tune2, sizeof(uint32_t));
+    dw3000_spi_xfer_init(x++, DRX_CONF_ID, DRX_TUNE0b_OFFSET, 1, p->drx_tune, sizeof(p->drx_tune));
+    if (regs.drx_tune4h) {
+        dw3000_spi_xfer_init(x, DRX_CONF_ID, DRX_TUNE4H_OFFSET, 1, NULL, sizeof(uint16_t));
+        memcpy((x++)->data, &regs.drx_tune4h, sizeof(uint16_t));
+    }
+    dw3000_spi_xfer_init(x, DRX_CONF_ID, DRX_SFDTOC_OFFSET, 1, NULL, sizeof(uint16_t));
+    memcpy((x++)->data, &regs.drx_sfdtoc, sizeof(uint16_t));
+
+    dw3000_spi_xfer_init(x, AGC_CTRL_ID, AGC_TUNE2_OFFSET, 1, NULL, sizeof(uint32_t));
+    memcpy((x++)->data, &regs.agc_tune2, sizeof(uint32_t));
+    dw3000_spi_xfer_init(x, AGC_CTRL_ID, AGC_TUNE1_OFFSET, 1, NULL, sizeof(uint16_t));
+    memcpy((x++)->data, &regs.agc_tune1, sizeof(uint16_t));
+
+    if (regs.usr_sfd) {
+        dw3000_spi_xfer_init(x, USR_SFD_ID, 0, 1, NULL, sizeof(uint8_t));
+        (x++)->data[0] = regs.usr_sfd;
+    }
+    dw3000_spi_xfer_init(x, CHAN_CTRL_ID, 0, 1, NULL, sizeof(uint32_t));
+    memcpy((x++)->data, &regs.chan_ctrl, sizeof(uint32_t));
+    dw3000_spi_xfer_init(x, TX_FCTRL_ID, 0, 1, NULL, sizeof(uint32_t));
+    memcpy((x++)->data, &regs.tx_fctrl, sizeof(uint32_t));
+
+    /* Request TX start and TRX off at the same time to initialise the SFD,
+     * see dw3000_mac_config */
+    dw3000_spi_xfer_init(x, SYS_CTRL_ID, 0, 1, NULL, sizeof(uint8_t));
+    (x++)->data[0] = SYS_CTRL_TXSTRT | SYS_CTRL_TRXOFF;
+
+    assert(x - p->xfer <= DW3000_PROFILE_XFER_MAX);
+    p->count = x - p->xfer;
+    return DPL_OK;
+}
+
+/**
+ * API to switch to a profile compiled with dw3000_mac_profile_compile. The register
+ * image is written in a single batched spi transaction of at most DW3000_PROFILE_XFER_MAX
+ * writes without any reads, SYS_CFG is taken from the shadow cache. The duration of
+ * the switch is kept in the PRF_hop_usec and PRF_hop_max mac stats.
+ *
+ * @param inst     Pointer to _dw3000_dev_instance_t.
+ * @param id       Profile id.
+ * @return struct uwb_dev_status, spi_w_error is set in the returned copy and nothing
+ * is written if id is out of range or hasn't been compiled
+ */
+struct uwb_dev_status
+dw3000_mac_profile_apply(struct _dw3000_dev_instance_t * inst, uint8_t id)
+{
+    dw3000_mac_profile_t * p;
+    uint32_t sys_cfg_reg;
+    uint32_t t0;
+    uint8_t dblbuff;
+    dpl_error_t err;
+
+    if (id >= MYNEWT_VAL(DW3000_MAC_PROFILES) || inst->profiles[id].count == 0) {
+        struct uwb_dev_status status = inst->uwb_dev.status;
+        status.spi_w_error = 1;
+        return status;
+    }
+    p = &inst->profiles[id];
+
+    err = dpl_mutex_pend(&inst->mutex,  DPL_TIMEOUT_NEVER); // Block if request pending
+    if (err != DPL_OK) {
+        inst->uwb_dev.status.mtx_error = 1;
+        goto mtx_error;
+    }
+    t0 = dpl_cputime_get32();
+
+    sys_cfg_reg = SYS_CFG_MASK & dw3000_read_reg_cached(inst, SYS_CFG_ID, 0, sizeof(uint32_t));
+    sys_cfg_reg = (sys_cfg_reg & ~DW3000_PROFILE_SYS_CFG_BITS) | p->sys_cfg;
+    memcpy(p->xfer[0].data, &sys_cfg_reg, sizeof(uint32_t));
+    dw3000_spi_xfer_submit(inst, p->xfer, p->count);
+
+    inst->sys_cfg_reg = sys_cfg_reg;
+    inst->tx_fctrl = p->tx_fctrl;
+    dblbuff = inst->uwb_dev.config.dblbuffon_enabled;
+    memcpy(&inst->uwb_dev.config, &p->config, sizeof(struct uwb_dev_config));
+    /* Realign the buffer pointers when entering or leaving double buffering as
+     * well, like dw3000_set_dblrxbuff, single buffer mode reads the buffer the
+     * host side pointer selects */
+    if (p->config.dblbuffon_enabled || dblbuff) {
+        dw3000_sync_rxbufptrs(inst);
+    }
+    inst->profile = id;
+
+#if MYNEWT_VAL(DW3000_MAC_STATS)
+    {
+        uint32_t usec = dpl_cputime_ticks_to_usecs(dpl_cputime_get32() - t0);
+        MAC_STATS_INC(PRF_hop_cnt);
+        STATS_SET(inst->stat, PRF_hop_usec, usec);
+        if (usec > inst->stat.PRF_hop_max) {
+            STATS_SET(inst->stat, PRF_hop_max, usec);
+        }
+    }
+#else
+    (void)t0;
+#endif
+    err = dpl_mutex_release(&inst->mutex);
+    assert(err == DPL_OK);
+mtx_error:
+    return inst->uwb_dev.status;
+}
+#endif
 
 /**
  * API to initialize the mac layer.
@@ -404,6 +650,7 @@ dw3000_mac_init(struct _dw3000_dev_instance_t * inst, struct uwb_dev_config * co
             STATS_SIZE_INIT_PARMS(inst->stat, STATS_SIZE_32),
             STATS_NAME_INIT_PARMS(mac_stat_section));
         assert(rc == 0);
+        STATS_SET(inst->stat, SPI_nb_thr, inst->spi_rd_max_noblock);
 
 #if  MYNEWT_VAL(DW3000_DEVICE_0) && !MYNEWT_VAL(DW3000_DEVICE_1)
         rc = stats_register("mac", STATS_HDR(inst->stat));
@@ -566,7 +813,7 @@ void dw3000_write_tx_fctrl(struct _dw3000_dev_instance_t * inst, uint16_t txFram
     /* Add frame length (+2 for CRC) and start-offset */
     tx_fctrl_reg |= ((txFrameLength + 2) & TX_FCTRL_FLE_MASK)  |
         (((uint32_t)txBufferOffset) << TX_FCTRL_TXBOFFS_SHFT);
-    dw3000_write_reg(inst, TX_FCTRL_ID, 0, tx_fctrl_reg, sizeof(uint32_t));
+    dw3000_wr_tx_fctrl(inst, tx_fctrl_reg);
 
     err = dpl_mutex_release(&inst->mutex);
     assert(err == DPL_OK);
@@ -586,7 +833,7 @@ dw3000_start_tx(struct _dw3000_dev_instance_t * inst)
     dw3000_dev_control_t control;
     struct uwb_dev_config *config;
     uint16_t sys_status_reg;
-    uint32_t sys_ctrl_reg;
+    dw3000_fast_cmd_t fast_cmd;
     dpl_error_t err = dpl_sem_pend(&inst->tx_sem,  DPL_TIMEOUT_NEVER); // Released by a SYS_STATUS_TXFRS event
     if (err != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
@@ -597,19 +844,19 @@ dw3000_start_tx(struct _dw3000_dev_instance_t * inst)
     config = &inst->uwb_dev.config;
 
     if (config->trxoff_enable){ // force return to idle state
-        dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint8_t) SYS_CTRL_TRXOFF, sizeof(uint8_t));
+        dw3000_fast_cmd(inst, DW3000_FCMD_TRXOFF);
     }
 
-    sys_ctrl_reg = SYS_CTRL_TXSTRT;
+    fast_cmd = DW3000_FCMD_TX;
     if (control.wait4resp_enabled){
-        sys_ctrl_reg |= SYS_CTRL_WAIT4RESP;
+        fast_cmd += DW3000_FCMD_W4R;
     }
     if (control.delay_start_enabled)
-        sys_ctrl_reg |= SYS_CTRL_TXDLYS;
+        fast_cmd += DW3000_FCMD_DLY;
 
-    dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint8_t) sys_ctrl_reg, sizeof(uint8_t));
+    dw3000_fast_cmd(inst, fast_cmd);
     if (control.delay_start_enabled){
-        sys_status_reg = dw3000_read_reg(inst, SYS_STATUS_ID, 3, sizeof(uint16_t)); // Read at offset 3 to get the upper 2 bytes out of 5
+        sys_status_reg = dw3000_rd_sys_status_b34(inst); // Read at offset 3 to get the upper 2 bytes out of 5
         inst->uwb_dev.status.start_tx_error = (sys_status_reg & ((SYS_STATUS_HPDWARN | SYS_STATUS_TXPUTE) >> 24)) != 0;
         if (inst->uwb_dev.status.start_tx_error){
             /*
@@ -620,7 +867,7 @@ dw3000_start_tx(struct _dw3000_dev_instance_t * inst)
             * a TRXOFF transceiver off command and then take whatever remedial action is deemed appropriate for the application.
             * Remedial action is cancle send and report error
             */
-            dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint8_t) SYS_CTRL_TRXOFF, sizeof(uint8_t));
+            dw3000_fast_cmd(inst, DW3000_FCMD_TRXOFF);
             err = dpl_sem_release(&inst->tx_sem);
             assert(err == DPL_OK);
         }
@@ -681,7 +928,7 @@ dw3000_set_delay_start(struct _dw3000_dev_instance_t * inst, uint64_t dx_time)
     }
 
     inst->control.delay_start_enabled = true;
-    dw3000_write_reg(inst, DX_TIME_ID, 1, dx_time >> 8, DX_TIME_LEN-1);
+    dw3000_wr_dx_time_hi(inst, dx_time >> 8);
 
     err = dpl_mutex_release(&inst->mutex);
     assert(err == DPL_OK);
@@ -700,7 +947,7 @@ mtx_error:
 struct uwb_dev_status
 dw3000_start_rx(struct _dw3000_dev_instance_t * inst)
 {
-    uint16_t sys_ctrl;
+    dw3000_fast_cmd_t fast_cmd;
     uint8_t sys_status;
     dw3000_dev_control_t control;
     struct uwb_dev_config *config;
@@ -715,32 +962,32 @@ dw3000_start_rx(struct _dw3000_dev_instance_t * inst)
     inst->uwb_dev.status.rx_restarted = 0;
 
     if (config->trxoff_enable){ // force return to idle state, if in RX state
-        uint8_t state = (uint8_t) dw3000_read_reg(inst, SYS_STATE_ID, PMSC_STATE_OFFSET, sizeof(uint8_t));
+        uint8_t state = (uint8_t) dw3000_rd_pmsc_state(inst);
         if(state != PMSC_STATE_IDLE){
-            dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint8_t) SYS_CTRL_TRXOFF, sizeof(uint8_t));
+            dw3000_fast_cmd(inst, DW3000_FCMD_TRXOFF);
         }
     }
 
-    sys_ctrl = SYS_CTRL_RXENAB;
+    fast_cmd = DW3000_FCMD_RX;
     if (config->dblbuffon_enabled) {
         dw3000_sync_rxbufptrs(inst);
     }
     if (control.delay_start_enabled)
-        sys_ctrl |= SYS_CTRL_RXDLYE;
+        fast_cmd += DW3000_FCMD_DLY;
 
     if (control.wait4resp_enabled) {
-        sys_ctrl |= SYS_CTRL_WAIT4RESP;
+        fast_cmd += DW3000_FCMD_W4R;
     }
 
-    dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, sys_ctrl, sizeof(uint16_t));
+    dw3000_fast_cmd(inst, fast_cmd);
     if (control.delay_start_enabled){   // check for errors
-        sys_status = dw3000_read_reg(inst, SYS_STATUS_ID, 3, sizeof(uint8_t));  // Read 1 byte at offset 3 to get the 4th byte out of 5
+        sys_status = dw3000_rd_sys_status_b3(inst);  // Read 1 byte at offset 3 to get the 4th byte out of 5
         inst->uwb_dev.status.start_rx_error = (sys_status & (SYS_STATUS_HPDWARN >> 24)) != 0;
         if (inst->uwb_dev.status.start_rx_error){   // if delay has passed do immediate RX on unless DWT_IDLE_ON_DLY_ERR is true
-            dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint8_t) SYS_CTRL_TRXOFF, sizeof(uint8_t)); // return to idle state
+            dw3000_fast_cmd(inst, DW3000_FCMD_TRXOFF); // return to idle state
             if (control.on_error_continue_enabled){
-                sys_ctrl &= ~SYS_CTRL_RXDLYE;
-                dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, sys_ctrl, sizeof(uint16_t)); // turn on receiver
+                fast_cmd -= DW3000_FCMD_DLY;
+                dw3000_fast_cmd(inst, fast_cmd); // turn on receiver
             }
         }
     }else{
@@ -778,10 +1025,10 @@ dw3000_stop_rx(struct _dw3000_dev_instance_t * inst)
         goto mtx_error;
     }
 
-    mask = dw3000_read_reg(inst, SYS_MASK_ID, 0 , sizeof(uint32_t)) ; // Read set interrupt mask
+    mask = dw3000_read_reg_cached(inst, SYS_MASK_ID, 0 , sizeof(uint32_t)) ; // Read set interrupt mask
     dw3000_write_reg(inst, SYS_MASK_ID, 0, 0, sizeof(uint32_t)) ; // Clear interrupt mask - so we don't get any unwanted events
-    dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint8_t) SYS_CTRL_TRXOFF, sizeof(uint8_t)); // return to idle state
-    dw3000_write_reg(inst, SYS_STATUS_ID, 0, (SYS_STATUS_ALL_TX | SYS_STATUS_ALL_RX_ERR | SYS_STATUS_ALL_RX_TO | SYS_STATUS_ALL_RX_GOOD), sizeof(uint32_t));
+    dw3000_fast_cmd(inst, DW3000_FCMD_TRXOFF); // return to idle state
+    dw3000_wr_sys_status(inst, SYS_STATUS_ALL_TX | SYS_STATUS_ALL_RX_ERR | SYS_STATUS_ALL_RX_TO | SYS_STATUS_ALL_RX_GOOD);
     dw3000_write_reg(inst, SYS_MASK_ID, 0, mask, sizeof(uint32_t)); // Restore mask to what it was
 
     err = dpl_mutex_release(&inst->mutex);
@@ -852,7 +1099,7 @@ dw3000_set_rxauto_disable(struct _dw3000_dev_instance_t * inst, bool disable)
 struct uwb_dev_status
 dw3000_adj_rx_timeout(struct _dw3000_dev_instance_t * inst, uint16_t timeout)
 {
-    dw3000_write_reg(inst, RX_FWTO_ID, RX_FWTO_OFFSET, timeout, sizeof(uint16_t));
+    dw3000_wr_rx_fwto(inst, timeout);
     return inst->uwb_dev.status;
 }
 
@@ -882,11 +1129,11 @@ dw3000_set_rx_timeout(struct _dw3000_dev_instance_t * inst, uint16_t timeout)
     }
 
     inst->uwb_dev.status.rx_timeout_error = 0;
-    sys_cfg_reg = dw3000_read_reg(inst, SYS_CFG_ID, 3, sizeof(uint8_t));
+    sys_cfg_reg = dw3000_read_reg_cached(inst, SYS_CFG_ID, 3, sizeof(uint8_t));
 
     inst->control.rx_timeout_enabled = timeout > 0;
     if(inst->control.rx_timeout_enabled) {
-        dw3000_write_reg(inst, RX_FWTO_ID, RX_FWTO_OFFSET, timeout, sizeof(uint16_t));
+        dw3000_wr_rx_fwto(inst, timeout);
         /* Only update sys_cfg if needed */
         new_reg_val = sys_cfg_reg | (SYS_CFG_RXWTOE>>24);
     } else {
@@ -985,11 +1232,11 @@ dw3000_sync_rxbufptrs(struct _dw3000_dev_instance_t * inst)
 
     inst->control.start_rx_syncbuf_enabled = 1;
     // Need to make sure that the host/IC buffer pointers are aligned before starting RX
-    buff = dw3000_read_reg(inst, SYS_STATUS_ID, 3, sizeof(uint8_t)); // Read 1 byte at offset 3 to get the 4th byte out of 5
+    buff = dw3000_rd_sys_status_b3(inst); // Read 1 byte at offset 3 to get the 4th byte out of 5
 
     if((buff & (SYS_STATUS_ICRBP >> 24)) !=         // IC side Receive Buffer Pointer
        ((buff & (SYS_STATUS_HSRBP >> 24)) << 1) )   // Host Side Receive Buffer Pointer
-        dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_HRBT_OFFSET, 0x01, sizeof(uint8_t)); // We need to swap RX buffer status reg (write one to toggle internally)
+        dw3000_fast_cmd(inst, DW3000_FCMD_HRBT); // We need to swap RX buffer status reg (write one to toggle internally)
 
     return inst->uwb_dev.status;
 }
@@ -1018,7 +1265,21 @@ dw3000_read_accdata(struct _dw3000_dev_instance_t * inst, uint8_t *buffer, uint1
 
     // Force on the ACC clocks if we are sequenced
     dw3000_phy_sysclk_ACC(inst, true);
-    dw3000_read(inst, ACC_MEM_ID, accOffset, buffer, len) ;
+    /* Read in bulk chunks to let other transfers on the bus through. Every
+     * read starts with a dummy octet, so each chunk after the first starts one
+     * octet early and the octet it overwrites is restored */
+    for (uint16_t offset = 0;offset < len;) {
+        uint16_t step = MYNEWT_VAL(DW3000_SPI_BULK_CHUNK) - (offset != 0);
+        uint16_t chunk = (len - offset > step) ? step : len - offset;
+        if (offset == 0) {
+            dw3000_read_bulk(inst, ACC_MEM_ID, accOffset, buffer, chunk);
+        } else {
+            uint8_t keep = buffer[offset - 1];
+            dw3000_read_bulk(inst, ACC_MEM_ID, accOffset + offset - 1, buffer + offset - 1, chunk + 1);
+            buffer[offset - 1] = keep;
+        }
+        offset += chunk;
+    }
     dw3000_phy_sysclk_ACC(inst, false);
 
     err = dpl_mutex_release(&inst->mutex);
@@ -1054,7 +1315,7 @@ dw3000_mac_framefilter(struct _dw3000_dev_instance_t * inst, uint16_t enable)
         goto mtx_error;
     }
 
-    sys_cfg_reg = SYS_CFG_MASK & dw3000_read_reg(inst, SYS_CFG_ID, 0, sizeof(uint32_t)) ; // Read sysconfig register
+    sys_cfg_reg = SYS_CFG_MASK & dw3000_read_reg_cached(inst, SYS_CFG_ID, 0, sizeof(uint32_t)) ; // Read sysconfig register
     inst->uwb_dev.config.rx.frameFilter = enable;
     if(enable > 0){   // Enable frame filtering and configure frame types
         sys_cfg_reg &= ~(SYS_CFG_FF_ALL_EN);  // Clear all
@@ -1090,7 +1351,7 @@ dw3000_set_autoack(struct _dw3000_dev_instance_t * inst, bool enable)
         goto mtx_error;
     }
 
-    sys_cfg_reg = SYS_CFG_MASK & dw3000_read_reg(inst, SYS_CFG_ID, 0, sizeof(uint32_t)); // Read sysconfig register
+    sys_cfg_reg = SYS_CFG_MASK & dw3000_read_reg_cached(inst, SYS_CFG_ID, 0, sizeof(uint32_t)); // Read sysconfig register
 
     inst->uwb_dev.config.autoack_enabled = enable;
     if(inst->uwb_dev.config.autoack_enabled){
@@ -1191,7 +1452,7 @@ dw3000_set_dblrxbuff(struct _dw3000_dev_instance_t * inst, bool enable)
         goto mtx_error;
     }
 
-    sys_cfg_reg = SYS_CFG_MASK & dw3000_read_reg(inst, SYS_CFG_ID, 0, sizeof(uint32_t));
+    sys_cfg_reg = SYS_CFG_MASK & dw3000_read_reg_cached(inst, SYS_CFG_ID, 0, sizeof(uint32_t));
 
     inst->uwb_dev.config.dblbuffon_enabled = enable;
     if(inst->uwb_dev.config.dblbuffon_enabled)
@@ -1278,6 +1539,29 @@ dw3000_calc_clock_offset_ratio(struct _dw3000_dev_instance_t * inst, int32_t int
     return ccor;
 }
 
+/**
+ * Sign extend the 19-bit RX_TTCKO time tracking offset.
+ *
+ * @param regval    First 3 bytes of RX_TTCKO.
+ * @return int32_t
+ */
+static int32_t
+dw3000_ttcko_sign_extend(uint32_t regval)
+{
+#define B18_SIGN_EXTEND_TEST (0x00040000UL)
+#define B18_SIGN_EXTEND_MASK (0xFFFC0000UL)
+    /* Check for a negative number */
+    if (regval & B18_SIGN_EXTEND_TEST) {
+        /* sign extend bit #18 to whole word */
+        regval |= B18_SIGN_EXTEND_MASK;
+    } else {
+        /* make sure upper bits are clear if not sign extending */
+        regval &= RX_TTCKO_RXTOFS_MASK;
+    }
+    /* cast unsigned value to signed quantity */
+    return (int32_t) regval;
+}
+
 /**
  * API for reading time tracking offset
  *
@@ -1295,22 +1579,8 @@ dw3000_calc_clock_offset_ratio(struct _dw3000_dev_instance_t * inst, int32_t int
 int32_t
 dw3000_read_time_tracking_offset(struct _dw3000_dev_instance_t * inst)
 {
-#define B18_SIGN_EXTEND_TEST (0x00040000UL)
-#define B18_SIGN_EXTEND_MASK (0xFFFC0000UL)
-    uint32_t  regval=0;
     /* Read 3 bytes (19-bit quantity) */
-    regval = dw3000_read_reg(inst, RX_TTCKO_ID, 0, 3);
-
-    /* Check for a negative number */
-    if (regval & B18_SIGN_EXTEND_TEST) {
-        /* sign extend bit #18 to whole word */
-        regval |= B18_SIGN_EXTEND_MASK;
-    } else {
-        /* make sure upper bits are clear if not sign extending */
-        regval &= RX_TTCKO_RXTOFS_MASK;
-    }
-    /* cast unsigned value to signed quantity */
-    return (int32_t) regval;
+    return dw3000_ttcko_sign_extend(dw3000_read_reg(inst, RX_TTCKO_ID, 0, 3));
 }
 
 /**
@@ -1345,11 +1615,216 @@ dw3000_read_rxdiag(struct _dw3000_dev_instance_t * inst, struct _dw3000_dev_rxdi
      * same order as the registers */
     dw3000_read(inst, RX_TIME_ID, RX_TIME_FP_INDEX_OFFSET, (uint8_t*)&diag->rx_time, sizeof(diag->rx_time));
     dw3000_read(inst, RX_FQUAL_ID, 0, (uint8_t*)&diag->rx_fqual, sizeof(diag->rx_fqual));
-    diag->pacc_cnt =  (dw3000_read_reg(inst, RX_FINFO_ID, 0, sizeof(uint32_t)) & RX_FINFO_RXPACC_MASK) >> RX_FINFO_RXPACC_SHIFT;
+    diag->pacc_cnt =  (dw3000_rd_rx_finfo(inst) & RX_FINFO_RXPACC_MASK) >> RX_FINFO_RXPACC_SHIFT;
     // diag->pacc_cnt_nosat =  (dw3000_read_reg(inst, DRX_CONF_ID, RPACC_NOSAT_OFFSET, sizeof(uint16_t)) & RPACC_NOSAT_MASK);
 }
 
 
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+/**
+ * Completion of a transfer of the interrupt top half capture, called from
+ * the spi interrupt. Once the last read is done the bottom half is queued.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param arg   The completed transfer.
+ * @param rc    DPL_OK if the transfer succeeded.
+ * @return void
+ */
+static void
+dw3000_irq_capture_cb(dw3000_dev_instance_t * inst, void * arg, int rc)
+{
+    dw3000_spi_async_t * xfer = arg;
+    dw3000_irq_capture_t * th = &inst->irq_th;
+
+    if (rc != DPL_OK) {
+        th->rc = rc;
+    }
+    if (xfer->next == NULL) {
+        /* Fall back to reading from the task if any of the reads failed */
+        th->state = (th->rc == DPL_OK) ? DW3000_IRQ_TH_READY : DW3000_IRQ_TH_IDLE;
+        dpl_eventq_put(&inst->uwb_dev.eventq, &inst->uwb_dev.interrupt_ev);
+    }
+}
+
+/**
+ * Prepare the chain of reads started by the interrupt top half.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+static void
+dw3000_irq_capture_init(dw3000_dev_instance_t * inst)
+{
+    dw3000_irq_capture_t * th = &inst->irq_th;
+
+    dw3000_spi_async_init(&th->xfer[0], SYS_STATUS_ID, 0, 0, th->sys_status, sizeof(th->sys_status),
+                          dw3000_irq_capture_cb, &th->xfer[0]);
+    dw3000_spi_async_init(&th->xfer[1], RX_FINFO_ID, RX_FINFO_OFFSET, 0, th->rx_finfo, sizeof(th->rx_finfo),
+                          dw3000_irq_capture_cb, &th->xfer[1]);
+    dw3000_spi_async_init(&th->xfer[2], RX_TIME_ID, RX_TIME_RX_STAMP_OFFSET, 0, th->rx_stamp, sizeof(th->rx_stamp),
+                          dw3000_irq_capture_cb, &th->xfer[2]);
+    th->xfer[0].next = &th->xfer[1];
+    th->xfer[1].next = &th->xfer[2];
+    th->xfer[2].next = NULL;
+    th->valid = 0;
+    th->state = DW3000_IRQ_TH_IDLE;
+}
+
+/**
+ * Little endian value of a captured register.
+ *
+ * @param buf   Captured register bytes.
+ * @param len   Number of bytes, at most 8.
+ * @return uint64_t
+ */
+static uint64_t
+dw3000_irq_capture_value(const uint8_t * buf, uint8_t len)
+{
+    uint64_t v = 0;
+    while (len--) {
+        v = (v << 8) | buf[len];
+    }
+    return v;
+}
+#endif
+
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+//! Rate measurement window of the adaptive interrupt polling
+#define DW3000_IRQ_POLL_WIN_USEC (10000)
+//! Interrupts within a window that switch to polling, at least two
+#define DW3000_IRQ_POLL_WIN_CNT \
+    ((MYNEWT_VAL(DW3000_IRQ_POLL_RATE) / (1000000 / DW3000_IRQ_POLL_WIN_USEC)) > 2 ? \
+     (MYNEWT_VAL(DW3000_IRQ_POLL_RATE) / (1000000 / DW3000_IRQ_POLL_WIN_USEC)) : 2)
+
+/**
+ * Polling timer, queues the interrupt bottom half.
+ *
+ * @param arg   Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+static void
+dw3000_irq_poll_timer_cb(void * arg)
+{
+    dw3000_dev_instance_t * inst = arg;
+    dpl_eventq_put(&inst->uwb_dev.eventq, &inst->uwb_dev.interrupt_ev);
+}
+
+/**
+ * Add the interrupts counted by the isr since the last bottom half and switch to polling
+ * once the rate exceeds DW3000_IRQ_POLL_RATE, or in polling mode schedule the next poll.
+ * Several interrupts can be handled by one run of the bottom half, a run without any
+ * counts as one as it was queued for an edge the isr missed.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+static void
+dw3000_irq_poll_update(dw3000_dev_instance_t * inst)
+{
+    dw3000_irq_poll_t * p = &inst->irq_poll;
+    uint32_t now;
+    uint16_t n;
+    os_sr_t sr;
+
+    if (p->active) {
+        dpl_cputime_timer_relative(&p->timer, MYNEWT_VAL(DW3000_IRQ_POLL_USEC));
+        return;
+    }
+    DPL_ENTER_CRITICAL(sr);
+    n = p->irq_cnt;
+    p->irq_cnt = 0;
+    DPL_EXIT_CRITICAL(sr);
+
+    now = dpl_cputime_get32();
+    if (now - p->win_start > dpl_cputime_usecs_to_ticks(DW3000_IRQ_POLL_WIN_USEC)) {
+        p->win_start = now;
+        p->win_cnt = 0;
+    }
+    p->win_cnt += (n) ? n : 1;
+    /* Polling would re-enable an interrupt disabled with dw3000_irq_disable */
+    if (p->win_cnt < DW3000_IRQ_POLL_WIN_CNT || p->user_off) {
+        return;
+    }
+    MAC_STATS_INC(POLL_enter);
+    hal_gpio_irq_disable(inst->irq_pin);
+    p->active = 1;
+    p->idle = 0;
+    dpl_cputime_timer_relative(&p->timer, MYNEWT_VAL(DW3000_IRQ_POLL_USEC));
+}
+
+/**
+ * A poll found no pending event, go back to interrupts after DW3000_IRQ_POLL_IDLE of them.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+static void
+dw3000_irq_poll_idle(dw3000_dev_instance_t * inst)
+{
+    dw3000_irq_poll_t * p = &inst->irq_poll;
+
+    if (++p->idle < MYNEWT_VAL(DW3000_IRQ_POLL_IDLE)) {
+        dpl_cputime_timer_relative(&p->timer, MYNEWT_VAL(DW3000_IRQ_POLL_USEC));
+        return;
+    }
+    p->active = 0;
+    p->win_cnt = 0;
+    p->irq_cnt = 0;
+    p->win_start = dpl_cputime_get32();
+    if (p->user_off) {
+        return;
+    }
+    hal_gpio_irq_enable(inst->irq_pin);
+    /* An event raised since the last poll has no edge to trigger the interrupt */
+    if (hal_gpio_read(inst->irq_pin)) {
+        dpl_eventq_put(&inst->uwb_dev.eventq, &inst->uwb_dev.interrupt_ev);
+    }
+}
+#endif
+
+/**
+ * API to disable the irq pin interrupt, e.g. while the device is in a test mode. With
+ * adaptive interrupt polling the interrupt stays disabled until dw3000_irq_enable, also
+ * when polling ends.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_irq_disable(dw3000_dev_instance_t * inst)
+{
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+    os_sr_t sr;
+    DPL_ENTER_CRITICAL(sr);
+    inst->irq_poll.user_off = 1;
+    DPL_EXIT_CRITICAL(sr);
+#endif
+    hal_gpio_irq_disable(inst->irq_pin);
+}
+
+/**
+ * API to enable the irq pin interrupt again after dw3000_irq_disable. If the device is
+ * being polled the interrupt is enabled when polling ends.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_irq_enable(dw3000_dev_instance_t * inst)
+{
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+    os_sr_t sr;
+    DPL_ENTER_CRITICAL(sr);
+    inst->irq_poll.user_off = 0;
+    if (inst->irq_poll.active) {
+        DPL_EXIT_CRITICAL(sr);
+        return;
+    }
+    DPL_EXIT_CRITICAL(sr);
+#endif
+    hal_gpio_irq_enable(inst->irq_pin);
+}
+
 /**
  * The DW3000 processing of interrupts in a task context instead of the interrupt context such that other interrupts
  * and high priority tasks are not blocked waiting for the interrupt handler to complete processing.
@@ -1368,6 +1843,17 @@ dw3000_tasks_init(struct _dw3000_dev_instance_t * inst)
     {
         /* Initialise task structures in uwb_dev */
         uwb_task_init(&inst->uwb_dev, dw3000_interrupt_ev_cb);
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+        dpl_cputime_timer_init(&inst->irq_poll.timer, dw3000_irq_poll_timer_cb, inst);
+        inst->irq_poll.active = 0;
+        inst->irq_poll.user_off = 0;
+        inst->irq_poll.win_cnt = 0;
+        inst->irq_poll.irq_cnt = 0;
+        inst->irq_poll.win_start = dpl_cputime_get32();
+#endif
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+        dw3000_irq_capture_init(inst);
+#endif
 
         /* Enable pull-down on IRQ to not get spurious interrupts when dw3000 is sleeping */
         hal_gpio_irq_init(inst->irq_pin, dw3000_irq, inst, HAL_GPIO_TRIG_RISING, HAL_GPIO_PULL_DOWN);
@@ -1375,13 +1861,17 @@ dw3000_tasks_init(struct _dw3000_dev_instance_t * inst)
     }
     /* Setup interrupt mask */
     dw3000_phy_interrupt_mask(inst,          SYS_MASK_MCPLOCK | SYS_MASK_MRXDFR | SYS_MASK_MLDEERR | SYS_MASK_MTXFRB | SYS_MASK_MTXFRS | SYS_MASK_ALL_RX_TO   | SYS_MASK_ALL_RX_ERR | SYS_MASK_MTXBERR, false);
-    dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_SLP2INIT | SYS_STATUS_CPLOCK| SYS_STATUS_RXDFR | SYS_STATUS_LDEERR | SYS_STATUS_TXFRB | SYS_STATUS_TXFRS | SYS_STATUS_ALL_RX_TO | SYS_STATUS_ALL_RX_ERR | SYS_STATUS_TXBERR, sizeof(uint32_t));
+    dw3000_wr_sys_status(inst, SYS_STATUS_SLP2INIT | SYS_STATUS_CPLOCK| SYS_STATUS_RXDFR | SYS_STATUS_LDEERR | SYS_STATUS_TXFRB | SYS_STATUS_TXFRS | SYS_STATUS_ALL_RX_TO | SYS_STATUS_ALL_RX_ERR | SYS_STATUS_TXBERR);
     dw3000_phy_interrupt_mask(inst,          SYS_MASK_MCPLOCK | SYS_MASK_MRXDFR | SYS_MASK_MLDEERR | SYS_MASK_MTXFRB | SYS_MASK_MTXFRS | SYS_MASK_ALL_RX_TO   | SYS_MASK_ALL_RX_ERR | SYS_MASK_MTXBERR, true);
+    /* CPLOCK was just cleared, a PLL that locked before won't raise it again */
+    dw3000_clk_check_lock(inst);
 }
 
 
 /**
- * API for the interrupt request.
+ * API for the interrupt request. With DW3000_IRQ_TOP_HALF the status, frame info
+ * and rx timestamp reads are started from here if the spi bus is free and no bottom
+ * half is running, the bottom half is then queued once they complete.
  *
  * @param arg  Pointer to the queue of interrupts.
  * @return void
@@ -1391,25 +1881,34 @@ dw3000_irq(void *arg)
 {
     dw3000_dev_instance_t * inst = arg;
     inst->uwb_dev.irq_at_ticks = dpl_cputime_get32();
-    if (!inst->uwb_dev.status.sleeping) {
-        dpl_eventq_put(&inst->uwb_dev.eventq, &inst->uwb_dev.interrupt_ev);
+    if (inst->uwb_dev.status.sleeping) {
+        return;
+    }
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+    /* Interrupts arriving while the bottom half is queued are counted here */
+    inst->irq_poll.irq_cnt++;
+#endif
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+    {
+        dw3000_irq_capture_t * th = &inst->irq_th;
+        if (th->state == DW3000_IRQ_TH_CAPTURE || th->state == DW3000_IRQ_TH_READY) {
+            /* Bottom half already on its way */
+            return;
+        }
+        if (th->state == DW3000_IRQ_TH_IDLE) {
+            th->state = DW3000_IRQ_TH_CAPTURE;
+            th->rc = DPL_OK;
+            if (hal_dw3000_async_try_submit(inst, &th->xfer[0]) == DPL_OK) {
+                return;
+            }
+            th->state = DW3000_IRQ_TH_IDLE;
+        }
     }
+#endif
+    dpl_eventq_put(&inst->uwb_dev.eventq, &inst->uwb_dev.interrupt_ev);
 }
 
 
-/**
- * Check for double buffer overrun error
- *
- * @param inst  Pointer to dw3000_dev_instance_t.
- * @return uint8_t 1 = overrun error has occured, 0 otherwise
- */
-static uint8_t
-dw3000_checkoverrun(dw3000_dev_instance_t * inst)
-{
-    uint8_t ov = dw3000_read_reg(inst, SYS_STATUS_ID, 2, sizeof(uint8_t)) & (SYS_STATUS_RXOVRR >> 16);
-    return (ov!=0);
-}
-
 /**
  * Check if IC and Host pointers are equal
  *
@@ -1419,393 +1918,1334 @@ dw3000_checkoverrun(dw3000_dev_instance_t * inst)
 uint8_t
 dw3000_ic_and_host_ptrs_equal(dw3000_dev_instance_t * inst)
 {
-    uint8_t b = dw3000_read_reg(inst, SYS_STATUS_ID, 3, sizeof(uint8_t));
+    uint8_t b = dw3000_rd_sys_status_b3(inst);
     /* Check where the receiver is at, and if it's in the same buffer as the host */
     return (uint8_t)((b & (SYS_STATUS_ICRBP >> 24)) == ((b & (SYS_STATUS_HSRBP >> 24)) << 1));
 }
 
 
 /**
- * This is the DW3000's general Interrupt Service Routine. It will process/report the following events:
- *          - RXFCG (through rx_complete_cb callback)
- *          - TXFRS (through tx_complete_cb callback)
- *          - RXRFTO/RXPTO (through rx_timeout_cb callback)
- *          - RXPHE/RXFCE/RXRFSL/RXSFDTO/AFFREJ/LDEERR (through rx_error_cb cbRxErr)
- * For all events, corresponding interrupts are cleared and necessary resets are performed. In addition, in the RXFCG case,
- * received frame information and frame control are read before calling the callback. If double buffering is activated, it
- * will also toggle between reception buffers once the reception callback processing has ended.
- *
- * @param ev  Pointer to the queue of events.
- * @return void
+ * Callback of an interface for an event.
  *
+ * @param cbs   Mac interface.
+ * @param id    Event, see dw3000_cb_id_t.
+ * @return dw3000_cb_fn_t NULL if the interface has no callback for the event
  */
-static void
-dw3000_interrupt_ev_cb(struct dpl_event *ev)
+static dw3000_cb_fn_t
+dw3000_mac_interface_cb(struct uwb_mac_interface * cbs, dw3000_cb_id_t id)
 {
-    uint16_t finfo;
-    struct uwb_mac_interface * cbs = NULL;
-    dw3000_dev_instance_t * inst = dpl_event_get_arg(ev);
-    dpl_error_t err = dpl_sem_pend(&inst->uwb_dev.irq_sem,  DPL_TIMEOUT_NEVER);
-    if (err != DPL_OK) {
-        inst->uwb_dev.status.sem_error = 1;
-        goto sem_error_exit;
+    switch (id) {
+    case DW3000_CB_RX_COMPLETE: return cbs->rx_complete_cb;
+    case DW3000_CB_TX_BEGINS: return cbs->tx_begins_cb;
+    case DW3000_CB_TX_COMPLETE: return cbs->tx_complete_cb;
+    case DW3000_CB_RX_TIMEOUT: return cbs->rx_timeout_cb;
+    case DW3000_CB_RX_ERROR: return cbs->rx_error_cb;
+    case DW3000_CB_CIR_COMPLETE: return cbs->cir_complete_cb;
+    case DW3000_CB_SLEEP: return cbs->sleep_cb;
+    case DW3000_CB_RESET: return cbs->reset_cb;
+    default: return NULL;
     }
+}
 
-    /* Read status register */
-#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)
-    {
-        uint32_t irq_utime = dpl_cputime_get32();
-#endif
-        inst->sys_status = dw3000_read_reg(inst, SYS_STATUS_ID, 0, sizeof(uint32_t));
-        /* Check for higher status bits only if needed */
-        if (!(inst->sys_status & (SYS_MASK_MCPLOCK | SYS_MASK_MRXDFR | SYS_MASK_MLDEERR | SYS_MASK_MTXFRB | SYS_MASK_MTXFRS | SYS_MASK_ALL_RX_TO | SYS_MASK_ALL_RX_ERR | SYS_MASK_MTXBERR))) {
-            inst->sys_status_hi = dw3000_read_reg(inst, SYS_STATUS_ID, 4, sizeof(uint8_t));
-        }
-
-#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)
-        if(!inst->sys_status_bt_lock) {
-            DW3000_SYS_STATUS_BT_ADD(inst, inst->sys_status, irq_utime);
-#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_HI)
-            DW3000_SYS_STATUS_BT_HI(inst, inst->sys_status_hi);
+#if MYNEWT_VAL(DW3000_CB_DISPATCH_MAX)
+/**
+ * API to rebuild the per event callback tables from uwb_dev.interface_cbs. Events are
+ * dispatched from the tables once they have been built, so this has to be called after
+ * every uwb_mac_append_interface and uwb_mac_remove_interface on the instance, and after
+ * changing the callbacks of an interface in the list. Until the first call events walk
+ * the interface list.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_mac_interface_update(struct _dw3000_dev_instance_t * inst)
+{
+    os_sr_t sr;
+    dw3000_cb_table_t * t = &inst->cb_table;
+    struct uwb_mac_interface * cbs;
+
+    DPL_ENTER_CRITICAL(sr);
+    memset(t->count, 0, sizeof(t->count));
+    SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next) {
+        for (int id = 0;id < DW3000_CB_NUM;id++) {
+            dw3000_cb_fn_t fn = dw3000_mac_interface_cb(cbs, id);
+            if (fn == NULL || t->count[id] == 0xFF) {
+                continue;
+            }
+            if (t->count[id] == MYNEWT_VAL(DW3000_CB_DISPATCH_MAX)) {
+                /* Too many, walk the list for this event */
+                t->count[id] = 0xFF;
+                continue;
+            }
+            t->entry[id][t->count[id]].fn = fn;
+            t->entry[id][t->count[id]].cbs = cbs;
+            t->count[id]++;
+        }
+    }
+    t->valid = 1;
+    DPL_EXIT_CRITICAL(sr);
+}
 #endif
+
+/**
+ * Call the callbacks of all mac interfaces but one for an event, in interface list order.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param id    Event, see dw3000_cb_id_t.
+ * @param stop  Stop at the first callback returning true.
+ * @param skip  Interface left out, NULL for none.
+ * @return void
+ */
+static void
+dw3000_mac_interface_dispatch_skip(struct _dw3000_dev_instance_t * inst, dw3000_cb_id_t id, bool stop,
+                                   struct uwb_mac_interface * skip)
+{
+    struct uwb_mac_interface * cbs = NULL;
+#if MYNEWT_VAL(DW3000_CB_DISPATCH_MAX)
+    dw3000_cb_table_t * t = &inst->cb_table;
+
+    if (t->valid && t->count[id] != 0xFF) {
+        for (int i = 0;i < t->count[id];i++) {
+            if (t->entry[id][i].cbs == skip) {
+                continue;
+            }
+            if (t->entry[id][i].fn((struct uwb_dev*)inst, t->entry[id][i].cbs) && stop) {
+                break;
+            }
         }
+        return;
     }
 #endif
+    SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next) {
+        dw3000_cb_fn_t fn = (cbs == skip) ? NULL : dw3000_mac_interface_cb(cbs, id);
+        if (fn && fn((struct uwb_dev*)inst, cbs) && stop) {
+            break;
+        }
+    }
+}
 
-    // Set status flags
-    inst->uwb_dev.status.rx_error = (inst->sys_status & SYS_STATUS_ALL_RX_ERR) !=0;
-    inst->uwb_dev.status.rx_error |= (inst->sys_status_hi & (SYS_STATUS_RXRSCS>>32)) != 0;
-    inst->uwb_dev.status.rx_autoframefilt_rej = (inst->sys_status & SYS_STATUS_AFFREJ) !=0;
-    inst->uwb_dev.status.rx_timeout_error = (inst->sys_status & SYS_STATUS_ALL_RX_TO) !=0;
-    inst->uwb_dev.status.lde_error = (inst->sys_status & SYS_STATUS_LDEDONE) == 0;
-    inst->uwb_dev.status.overrun_error = (inst->sys_status & SYS_STATUS_RXOVRR) != 0;
-    inst->uwb_dev.status.txbuf_error = (inst->sys_status & SYS_STATUS_TXBERR) != 0;
-    inst->uwb_dev.status.autoack_triggered = (inst->sys_status & SYS_STATUS_AAT) != 0;
-    inst->uwb_dev.status.rx_prej = (inst->sys_status_hi & (SYS_STATUS_RXPREJ>>32)) != 0;
+/**
+ * API to call the callbacks of all mac interfaces for an event, in interface list order.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param id    Event, see dw3000_cb_id_t.
+ * @param stop  Stop at the first callback returning true.
+ * @return void
+ */
+void
+dw3000_mac_interface_dispatch(struct _dw3000_dev_instance_t * inst, dw3000_cb_id_t id, bool stop)
+{
+    dw3000_mac_interface_dispatch_skip(inst, id, stop, NULL);
+}
 
-    /* Clear tx_sem unless this is a TXFRB and not TXFRS */
-    if(dpl_sem_get_count(&inst->tx_sem) == 0 && !(
-           (inst->sys_status & SYS_STATUS_TXFRB) != 0 &&
-           (inst->sys_status & SYS_STATUS_TXFRS) == 0
-           )) {
-        dpl_error_t err = dpl_sem_release(&inst->tx_sem);
-        assert(err == DPL_OK);
+#if MYNEWT_VAL(DW3000_RX_LAZY_HDR)
+//! Frame bytes read before the header callback, frame control included
+#define DW3000_RX_LAZY_HDR_LEN ((MYNEWT_VAL(DW3000_RX_LAZY_HDR) > 2) ? MYNEWT_VAL(DW3000_RX_LAZY_HDR) : 2)
+
+/**
+ * API to set the rx header callback. With a callback set only the first DW3000_RX_LAZY_HDR
+ * bytes of a received frame are read, the callback decides how much more is needed. The
+ * callback is global to the instance, not per mac interface, so it has to ask for what
+ * every interface needs. A frame not read in full is passed on with uwb_dev.frame_len
+ * cut to the bytes read, so the services never parse the stale tail of rxbuf, its length
+ * as received is kept in rx_frame_len.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param cb    Header callback, NULL to read whole frames.
+ * @param arg   Argument passed to cb.
+ * @return void
+ */
+void
+dw3000_rx_set_hdr_cb(struct _dw3000_dev_instance_t * inst, dw3000_rx_hdr_cb_t cb, void * arg)
+{
+    os_sr_t sr;
+    DPL_ENTER_CRITICAL(sr);
+    inst->rx_hdr_cb = cb;
+    inst->rx_hdr_arg = arg;
+    DPL_EXIT_CRITICAL(sr);
+}
+
+/**
+ * Read the header of the frame just received, and as much of the rest as the
+ * header callback asks for.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param have  Number of frame bytes already in uwb_dev.rxbuf.
+ * @return void
+ */
+static void
+dw3000_rx_read_lazy(dw3000_dev_instance_t * inst, uint16_t have)
+{
+    uint16_t len = (inst->uwb_dev.frame_len < inst->uwb_dev.rxbuf_size) ?
+        inst->uwb_dev.frame_len : inst->uwb_dev.rxbuf_size;
+    uint16_t hdr = DW3000_RX_LAZY_HDR_LEN;
+    uint16_t want;
+
+#if MYNEWT_VAL(DW3000_RX_DEMUX_MAX)
+    if (inst->demux_hdr > hdr) {
+        hdr = inst->demux_hdr;
+    }
+#endif
+    if (have > hdr) {
+        hdr = have;
     }
+    inst->rx_fetched = (len < hdr) ? len : hdr;
+    if (inst->rx_fetched > have) {
+        dw3000_read_rx(inst, inst->uwb_dev.rxbuf + have, have, inst->rx_fetched - have);
+    }
+    inst->uwb_dev.fctrl = ((uint16_t)inst->uwb_dev.rxbuf[1]<<8) | inst->uwb_dev.rxbuf[0];
+
+    want = inst->rx_hdr_cb(inst, inst->rx_hdr_arg);
+    if (want > len) {
+        want = len;
+    }
+    if (want > inst->rx_fetched) {
+        dw3000_read_rx(inst, inst->uwb_dev.rxbuf + inst->rx_fetched, inst->rx_fetched, want - inst->rx_fetched);
+        inst->rx_fetched = want;
+    }
+    if (inst->rx_fetched < len) {
+        /* What the services see ends with the bytes read */
+        inst->uwb_dev.frame_len = inst->rx_fetched;
+    }
+    MAC_STATS_INCN(RXL_skip_bytes, len - inst->rx_fetched);
+}
+#endif
+
+#if MYNEWT_VAL(DW3000_RX_DEMUX_MAX)
+/**
+ * API to add an rx demultiplexer rule. Received frames are compared against the rules
+ * in the order they were added, the first match is passed to the rx_complete_cb of the
+ * rule's interface first. If it returns false, or no rule matches, the frame is offered
+ * to the other interfaces. Rules of an interface no longer in uwb_dev.interface_cbs are
+ * dropped when they next match.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param rule  Rule, copied.
+ * @return int  DPL_OK, DPL_EINVAL if the rule is invalid, DPL_ENOMEM if the table is full
+ */
+int
+dw3000_rx_demux_add(struct _dw3000_dev_instance_t * inst, const dw3000_rx_demux_rule_t * rule)
+{
+    os_sr_t sr;
+    dw3000_rx_demux_entry_t * e;
+
+    if (rule->len > sizeof(uint32_t) || rule->cbs == NULL || rule->cbs->rx_complete_cb == NULL) {
+        return DPL_EINVAL;
+    }
+    if (inst->demux_count >= MYNEWT_VAL(DW3000_RX_DEMUX_MAX)) {
+        return DPL_ENOMEM;
+    }
+    e = &inst->demux[inst->demux_count];
+    e->fctrl_mask = rule->fctrl_mask;
+    e->fctrl = rule->fctrl & rule->fctrl_mask;
+    e->offset = rule->offset;
+    e->min_len = rule->offset + rule->len;
+    e->mask = (rule->len == sizeof(uint32_t)) ? rule->mask : rule->mask & ((1UL << (8 * rule->len)) - 1);
+    e->value = rule->value & e->mask;
+    e->cbs = rule->cbs;
+
+    DPL_ENTER_CRITICAL(sr);
+    if (e->min_len > inst->demux_hdr) {
+        inst->demux_hdr = e->min_len;
+    }
+    inst->demux_count++;
+    DPL_EXIT_CRITICAL(sr);
+    return DPL_OK;
+}
 
-    // leading edge detection complete
-    if((inst->sys_status & SYS_STATUS_RXFCG)){
-        MAC_STATS_INC(DFR_cnt);
+/**
+ * API to remove the rx demultiplexer rules of an interface, to be called before the
+ * interface is removed.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param cbs   Owning interface.
+ * @return void
+ */
+void
+dw3000_rx_demux_remove(struct _dw3000_dev_instance_t * inst, struct uwb_mac_interface * cbs)
+{
+    os_sr_t sr;
+    uint8_t n = 0;
+
+    DPL_ENTER_CRITICAL(sr);
+    inst->demux_hdr = 0;
+    for (int i = 0;i < inst->demux_count;i++) {
+        if (inst->demux[i].cbs == cbs) {
+            continue;
+        }
+        inst->demux[n] = inst->demux[i];
+        if (inst->demux[n].min_len > inst->demux_hdr) {
+            inst->demux_hdr = inst->demux[n].min_len;
+        }
+        n++;
+    }
+    inst->demux_count = n;
+    DPL_EXIT_CRITICAL(sr);
+}
 
-        if (inst->uwb_dev.status.overrun_error){
+/**
+ * Check that an interface is still in uwb_dev.interface_cbs.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param cbs   Interface.
+ * @return bool
+ */
+static bool
+dw3000_rx_demux_registered(dw3000_dev_instance_t * inst, struct uwb_mac_interface * cbs)
+{
+    struct uwb_mac_interface * it;
+    SLIST_FOREACH(it, &inst->uwb_dev.interface_cbs, next) {
+        if (it == cbs) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * API to remove all rx demultiplexer rules.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_rx_demux_clear(struct _dw3000_dev_instance_t * inst)
+{
+    inst->demux_count = 0;
+    inst->demux_hdr = 0;
+}
+
+/**
+ * Pass the frame just received to the interface of the first matching rx demultiplexer rule.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @param owner Set to the interface the frame was passed to, NULL if no rule matched.
+ * @return bool true if the owner took the frame, false if it's to be offered to the others
+ */
+static bool
+dw3000_rx_demux(dw3000_dev_instance_t * inst, struct uwb_mac_interface ** owner)
+{
+#if MYNEWT_VAL(DW3000_RX_LAZY_HDR)
+    uint16_t len = inst->rx_fetched;
+#else
+    uint16_t len = (inst->uwb_dev.frame_len < inst->uwb_dev.rxbuf_size) ?
+        inst->uwb_dev.frame_len : inst->uwb_dev.rxbuf_size;
+#endif
+
+    *owner = NULL;
+    for (int i = 0;i < inst->demux_count;i++) {
+        const dw3000_rx_demux_entry_t * e = &inst->demux[i];
+        uint32_t data = 0;
+
+        if ((inst->uwb_dev.fctrl & e->fctrl_mask) != e->fctrl || len < e->min_len) {
+            continue;
+        }
+        for (int j = e->min_len - 1;j >= e->offset;j--) {
+            data = (data << 8) | inst->uwb_dev.rxbuf[j];
+        }
+        if ((data & e->mask) != e->value) {
+            continue;
+        }
+        if (!dw3000_rx_demux_registered(inst, e->cbs)) {
+            /* Owner has gone, its rules are dropped and this one tried again */
+            dw3000_rx_demux_remove(inst, e->cbs);
+            i--;
+            continue;
+        }
+        MAC_STATS_INC(RXD_hit);
+        *owner = e->cbs;
+        return (e->cbs->rx_complete_cb && e->cbs->rx_complete_cb((struct uwb_dev*)inst, e->cbs));
+    }
+    MAC_STATS_INC(RXD_miss);
+    return false;
+}
+#endif
+
+#if MYNEWT_VAL(DW3000_RX_FILTER_MAX)
+/**
+ * API to compile and set the software frame filter, see dw3000_rx_filter_build for the
+ * rules. The program is built with uwb_dev.irq_sem held, so the interrupt bottom half,
+ * which evaluates the filter, never sees it half written. Can also be called from the
+ * mac interface callbacks. The per rule hit counters of the program, in
+ * inst->rx_filter.prog, start from zero.
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param rules     Rules, compiled, not referenced afterwards.
+ * @param nrules    Number of rules, at most DW3000_RX_FILTER_RULES.
+ * @param accept    Accept frames matching no rule if true, reject them otherwise.
+ * @return int      DPL_OK, DPL_EINVAL if a rule is invalid, DPL_ENOMEM if the program doesn't
+ *                  fit in DW3000_RX_FILTER_MAX instructions. The filter is cleared on error.
+ */
+int
+dw3000_rx_filter_compile(struct _dw3000_dev_instance_t * inst, const dw3000_rx_filter_rule_t * rules, uint8_t nrules, bool accept)
+{
+    dw3000_rx_filter_t * f = &inst->rx_filter;
+    /* The bottom half, callbacks included, already holds irq_sem */
+    bool locked = (inst->spi_irq_task != dpl_get_current_task_id());
+    int rc;
+
+    if (locked) {
+        rc = dpl_sem_pend(&inst->uwb_dev.irq_sem, DPL_TIMEOUT_NEVER);
+        if (rc != DPL_OK) {
+            inst->uwb_dev.status.sem_error = 1;
+            return rc;
+        }
+    }
+    rc = dw3000_rx_filter_build(&f->prog, rules, nrules, accept);
+    f->active = (rc == DPL_OK);
+    if (locked) {
+        dpl_sem_release(&inst->uwb_dev.irq_sem);
+    }
+    return rc;
+}
+
+/**
+ * API to clear the software frame filter, all frames are passed on.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_rx_filter_clear(struct _dw3000_dev_instance_t * inst)
+{
+    os_sr_t sr;
+    DPL_ENTER_CRITICAL(sr);
+    inst->rx_filter.active = 0;
+    DPL_EXIT_CRITICAL(sr);
+}
+
+/**
+ * Read the header of the frame just received and run the software frame filter on it.
+ * At least the frame control is read, a rejected frame needs it in dw3000_rx_aat.
+ * Called from the interrupt bottom half with uwb_dev.irq_sem held.
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param rx_len    Frame bytes that fit in uwb_dev.rxbuf.
+ * @param have      Set to the number of frame bytes read into uwb_dev.rxbuf.
+ * @return bool true if the frame is accepted, or no filter is set
+ */
+static bool
+dw3000_rx_filter_run(dw3000_dev_instance_t * inst, uint16_t rx_len, uint16_t * have)
+{
+    dw3000_rx_filter_t * f = &inst->rx_filter;
+    uint16_t hdr_len;
+    bool accept;
+
+    if (!f->active) {
+        return true;
+    }
+    hdr_len = (f->prog.hdr_len > sizeof(uint16_t)) ? f->prog.hdr_len : sizeof(uint16_t);
+    *have = (rx_len < hdr_len) ? rx_len : hdr_len;
+    if (*have) {
+        dw3000_read_rx(inst, inst->uwb_dev.rxbuf, 0, *have);
+    }
+    accept = dw3000_rx_filter_eval(&f->prog, inst->uwb_dev.rxbuf, *have, inst->uwb_dev.frame_len);
+    if (accept) {
+        MAC_STATS_INC(RXF_accept);
+    }
+    return accept;
+}
+#endif
+
+#if MYNEWT_VAL(DW3000_RX_RING_LEN)
+_Static_assert((MYNEWT_VAL(DW3000_RX_RING_LEN) & (MYNEWT_VAL(DW3000_RX_RING_LEN) - 1)) == 0,
+               "DW3000_RX_RING_LEN must be a power of two");
+
+/**
+ * API to attach the consumer task of the rx ring. From now on received frames
+ * are queued in the ring and taken with dw3000_rx_ring_get, rx_complete_cb of
+ * the mac interfaces is no longer called for them. Frames left from an
+ * earlier attachment are discarded.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_rx_ring_attach(struct _dw3000_dev_instance_t * inst)
+{
+    dpl_error_t err;
+    if (inst->rx_ring_attached) {
+        return;
+    }
+    inst->rx_ring_head = 0;
+    inst->rx_ring_tail = 0;
+    err = dpl_sem_init(&inst->rx_ring_sem, 0);
+    assert(err == DPL_OK);
+    inst->rx_ring_attached = 1;
+}
+
+/**
+ * API to detach the consumer task of the rx ring, received frames go to
+ * rx_complete_cb again. Called from the consumer task, frames still queued
+ * are discarded.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_rx_ring_detach(struct _dw3000_dev_instance_t * inst)
+{
+    inst->rx_ring_attached = 0;
+}
+
+/**
+ * Copy the frame just received, with its timestamp and diagnostics, into the
+ * next free rx ring descriptor. The frame is dropped if the ring is full.
+ * Only called with a consumer attached.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+static void
+dw3000_rx_ring_put(dw3000_dev_instance_t * inst)
+{
+    dw3000_rx_desc_t * d;
+    uint16_t depth = inst->rx_ring_head - inst->rx_ring_tail;
+
+    if (depth >= MYNEWT_VAL(DW3000_RX_RING_LEN)) {
+        MAC_STATS_INC(RXR_drop);
+        return;
+    }
+    d = &inst->rx_ring[inst->rx_ring_head % MYNEWT_VAL(DW3000_RX_RING_LEN)];
+    d->rxtimestamp = inst->uwb_dev.rxtimestamp;
+    d->carrier_integrator = (inst->uwb_dev.config.dblbuffon_enabled) ? 0 : inst->uwb_dev.carrier_integrator;
+    d->fctrl = inst->uwb_dev.fctrl;
+    d->frame_len = inst->uwb_dev.frame_len;
+#if MYNEWT_VAL(DW3000_RX_LAZY_HDR)
+    d->len = inst->rx_fetched;
+#else
+    d->len = (inst->uwb_dev.frame_len < inst->uwb_dev.rxbuf_size) ? inst->uwb_dev.frame_len : inst->uwb_dev.rxbuf_size;
+#endif
+    if (d->len > sizeof(d->payload)) {
+        d->len = sizeof(d->payload);
+    }
+    memcpy(d->payload, inst->uwb_dev.rxbuf, d->len);
+    if (inst->uwb_dev.config.rxdiag_enable) {
+        memcpy(&d->rxdiag, &inst->rxdiag, sizeof(d->rxdiag));
+    } else {
+        memset(&d->rxdiag, 0, sizeof(d->rxdiag));
+    }
+    inst->rx_ring_head++;
+    depth++;
+
+#if MYNEWT_VAL(DW3000_MAC_STATS)
+    if (depth > inst->stat.RXR_hwm) {
+        STATS_SET(inst->stat, RXR_hwm, depth);
+    }
+#endif
+    dpl_sem_release(&inst->rx_ring_sem);
+}
+
+/**
+ * API to take the oldest received frame from the rx ring. The descriptor stays
+ * owned by the caller until dw3000_rx_ring_release. Only one task may consume
+ * the ring of an instance.
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param timeout   Time to wait for a frame, in os ticks.
+ * @return dw3000_rx_desc_t * Oldest received frame, NULL on timeout
+ */
+dw3000_rx_desc_t *
+dw3000_rx_ring_get(struct _dw3000_dev_instance_t * inst, dpl_time_t timeout)
+{
+    if (dpl_sem_pend(&inst->rx_ring_sem, timeout) != DPL_OK) {
+        return NULL;
+    }
+    return &inst->rx_ring[inst->rx_ring_tail % MYNEWT_VAL(DW3000_RX_RING_LEN)];
+}
+
+/**
+ * API to free the descriptor returned by dw3000_rx_ring_get.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+void
+dw3000_rx_ring_release(struct _dw3000_dev_instance_t * inst)
+{
+    assert(inst->rx_ring_head != inst->rx_ring_tail);
+    inst->rx_ring_tail++;
+}
+#endif
+
+/**
+ * Decide whether the AAT status bit, set with the frame just received, is to be cleared.
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param rx_clear  Set if the rx status bits are to be cleared with the buffer swap.
+ * @return uint32_t SYS_STATUS_AAT if it is to be cleared with the rx status bits, 0 otherwise
+ */
+static uint32_t
+dw3000_rx_aat(dw3000_dev_instance_t * inst, bool * rx_clear)
+{
+    uint32_t aat = 0;
+
+    if (inst->uwb_dev.status.autoack_triggered) {
+        /* Because of a previous frame not being received properly, AAT bit can be set upon the proper reception of a frame not requesting for
+         * acknowledgement (ACK frame is not actually sent though). If the AAT bit is set, check ACK request bit in frame control to confirm (this
+         * implementation works only for IEEE802.15.4-2011 compliant frames).
+         * This issue is not documented at the time of writing this code. It should be in next release of DW3000 User Manual (v2.09, from July 2016). */
+        if ((inst->uwb_dev.fctrl & UWB_FCTRL_ACK_REQUESTED) == 0){
+            /* Clear AAT status bit in callback data register copy and status,
+             * together with the rx status below */
+            aat = SYS_STATUS_AAT;
+            inst->sys_status &= ~SYS_STATUS_AAT;
+            inst->uwb_dev.status.autoack_triggered = 0;
+        } else {
+            /* Clear RX flags in sys_status, in double buffer mode with the buffer swap */
+            if (inst->uwb_dev.config.dblbuffon_enabled) {
+                *rx_clear = true;
+            } else {
+                dw3000_wr_sys_status_b1(inst, (inst->sys_status&(SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR))>>8);
+            }
+        }
+    }
+    return aat;
+}
+
+/**
+ * Hand the frame just received back to the receiver. In double buffer mode the rx status
+ * bits are cleared and the host side buffer swapped, or the receiver reset on overrun. In
+ * single buffer mode the rx status bits are cleared and the receiver re-enabled.
+ *
+ * @param inst      Pointer to dw3000_dev_instance_t.
+ * @param rxbuf_st  SYS_STATUS bytes 2 and 3, double buffer mode only.
+ * @param aat       SYS_STATUS_AAT if it is to be cleared, see dw3000_rx_aat.
+ * @param rx_clear  Clear the rx status bits with the buffer swap.
+ * @param rejected  Frame rejected by the software frame filter, in single buffer mode the
+ *                  receiver is re-enabled and rxauto_disable kept as if it never arrived.
+ * @return void
+ */
+static void
+dw3000_rx_release(dw3000_dev_instance_t * inst, uint16_t rxbuf_st, uint32_t aat, bool rx_clear, bool rejected)
+{
+    dw3000_spi_batch_t batch;
+
+    // Toggle the Host side Receive Buffer Pointer
+    if (inst->uwb_dev.config.dblbuffon_enabled) {
+        uint8_t rx_flags = (inst->sys_status&(SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR))>>8;
+        uint8_t b3 = rxbuf_st >> 8;
+
+        inst->uwb_dev.status.overrun_error = (rxbuf_st & (SYS_STATUS_RXOVRR >> 16)) != 0;
+        dw3000_spi_batch_init(&batch);
+        if (aat) {
+            dw3000_spi_batch_write_reg(&batch, SYS_STATUS_ID, 0, SYS_STATUS_AAT, sizeof(uint8_t));
+        }
+        if (inst->uwb_dev.status.overrun_error == 0) {
+            /* Check where the receiver is at, and if it's in the same buffer as we are,
+             * mask out interrupt flags to avoid spurious interrupts when clearing status bits */
+            if (inst->uwb_dev.config.rxauto_enable &&
+                (b3 & (SYS_STATUS_ICRBP >> 24)) == ((b3 & (SYS_STATUS_HSRBP >> 24)) << 1)) {
+                uint8_t mask = dw3000_read_reg_cached(inst, SYS_MASK_ID, 1 , sizeof(uint8_t));
+                dw3000_spi_batch_write_reg(&batch, SYS_MASK_ID, 1, 0, sizeof(uint8_t));
+                dw3000_spi_batch_write_reg(&batch, SYS_STATUS_ID, 1, rx_flags, sizeof(uint8_t));
+                dw3000_spi_batch_write_reg(&batch, SYS_MASK_ID, 1, mask, sizeof(uint8_t));
+            } else if (inst->uwb_dev.config.rxauto_enable || rx_clear) {
+                dw3000_spi_batch_write_reg(&batch, SYS_STATUS_ID, 1, rx_flags, sizeof(uint8_t));
+            }
+            /* Swap buffers, the IC keeps receiving into the other one while this frame is processed */
+            dw3000_spi_batch_write_reg(&batch, SYS_CTRL_ID, SYS_CTRL_HRBT_OFFSET , 0b1, sizeof(uint8_t));
+            dw3000_spi_batch_submit(inst, &batch);
+        }else{
             MAC_STATS_INC(ROV_err);
-            /* Overrun flag has been set */
-            dw3000_write_reg(inst, SYS_STATUS_ID, 0, (SYS_STATUS_RXOVRR |SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR), sizeof(uint32_t));
+            if (rx_clear) {
+                dw3000_spi_batch_write_reg(&batch, SYS_STATUS_ID, 1, rx_flags, sizeof(uint8_t));
+            }
+            dw3000_spi_batch_submit(inst, &batch);
+            /* Overrun flag has been set, reset receiver and realign buffers */
+            dw3000_wr_sys_status(inst, SYS_STATUS_RXOVRR);
             dw3000_phy_forcetrxoff(inst);
             dw3000_phy_rx_reset(inst);
             dw3000_sync_rxbufptrs(inst);
-            dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-            goto early_exit;
+            dw3000_fast_cmd(inst, DW3000_FCMD_RX);
+        }
+    }else{
+        /* Clear status and restart the receiver in one bus transaction */
+        dw3000_spi_batch_init(&batch);
+        dw3000_spi_batch_write_reg(&batch, SYS_STATUS_ID, 0,
+                                   (inst->sys_status & (SYS_STATUS_LDEDONE | SYS_STATUS_RXPHD | SYS_STATUS_RXDFR |
+                                                        SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR)) | aat,
+                                   sizeof(uint16_t));
+        if (inst->control.rxauto_disable == false || rejected){
+            dw3000_spi_batch_write_reg(&batch, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
+            inst->uwb_dev.status.rx_restarted = 1;
+        }
+        dw3000_spi_batch_submit(inst, &batch);
+        if (!rejected) {
+            inst->control.rxauto_disable = false;
         }
 
-        // The DW3000 has a bug that render the hardware auto_enable feature useless when used in conjunction with the double buffering.
-        // Consequently, we reenable the transeiver in the MAC-layer as early as possable. Note: The default behavior of MAC-Layer
-        // is that the transceiver only returns to the IDLE state with a timeout event occured. The MAC-layer should otherwise reenable.
+    }
+}
 
-        if (inst->uwb_dev.config.rxauto_enable == 0 && inst->uwb_dev.config.dblbuffon_enabled) {
-            if (inst->control.rxauto_disable == false && !inst->uwb_dev.status.autoack_triggered) {
-                dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-                inst->uwb_dev.status.rx_restarted = 1;
-            }
-            inst->control.rxauto_disable = false;
+#if MYNEWT_VAL(DW3000_RX_FILTER_MAX)
+/**
+ * Release a frame rejected by the software frame filter. Nothing else of the frame is read,
+ * apart from the buffer status in double buffer mode and the timestamp if the rx window
+ * has an absolute end. As no callback is called the frame is handled as if it never
+ * arrived: the receiver is re-enabled even with rxauto_disable set, which is kept for the
+ * next frame.
+ *
+ * @param inst              Pointer to dw3000_dev_instance_t.
+ * @param rxauto_disable    control.rxauto_disable as the frame arrived.
+ * @return void
+ */
+static void
+dw3000_rx_filter_reject(dw3000_dev_instance_t * inst, bool rxauto_disable)
+{
+    dw3000_spi_batch_t batch;
+    int ts_idx = -1, st_idx = -1;
+    uint16_t rxbuf_st = 0;
+    uint32_t aat;
+    bool rx_clear = false;
+
+    MAC_STATS_INC(RXF_reject);
+    dw3000_spi_batch_init(&batch);
+    if (inst->control.abs_timeout) {
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+        if (inst->irq_th.valid) {
+            inst->uwb_dev.rxtimestamp = dw3000_irq_capture_value(inst->irq_th.rx_stamp, RX_TIME_RX_STAMP_LEN) & 0x0FFFFFFFFFFULL;
+        } else
+#endif
+        {
+            ts_idx = dw3000_spi_batch_read_reg(&batch, RX_TIME_ID, RX_TIME_RX_STAMP_OFFSET, RX_TIME_RX_STAMP_LEN);
         }
+    }
+    if (inst->uwb_dev.config.dblbuffon_enabled) {
+        st_idx = dw3000_spi_batch_read_reg(&batch, SYS_STATUS_ID, 2, sizeof(uint16_t));
+    }
+    if (batch.count) {
+        dw3000_spi_batch_submit(inst, &batch);
+    }
+
+    if (ts_idx >= 0) {
+        inst->uwb_dev.rxtimestamp = dw3000_spi_batch_value(&batch, ts_idx) & 0x0FFFFFFFFFFULL;
+    }
+    if (st_idx >= 0) {
+        rxbuf_st = dw3000_spi_batch_value(&batch, st_idx);
+    }
+    if (inst->control.abs_timeout) {
+        update_rx_window_timeout(inst, inst->uwb_dev.rxtimestamp);
+    }
+
+    aat = dw3000_rx_aat(inst, &rx_clear);
+    dw3000_rx_release(inst, rxbuf_st, aat, rx_clear, true);
+
+    /* Double buffering without rxauto was only restarted early if rxauto_disable wasn't set */
+    if (rxauto_disable && inst->uwb_dev.config.dblbuffon_enabled && inst->uwb_dev.config.rxauto_enable == 0 &&
+        !inst->uwb_dev.status.autoack_triggered && !inst->uwb_dev.status.overrun_error) {
+        dw3000_fast_cmd(inst, DW3000_FCMD_RX);
+        inst->uwb_dev.status.rx_restarted = 1;
+    }
+    inst->control.rxauto_disable = rxauto_disable;
+}
+#endif
+
+/**
+ * Receive frame event, RXFCG. Reads the frame, timestamp and diagnostics, re-enables
+ * the receiver and calls rx_complete_cb. The rx status bits are cleared here rather
+ * than in the coalesced clear as they have to be cleared before the receiver is
+ * re-enabled or the host buffer swapped.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return bool true if the remaining events are to be skipped
+ */
+static bool
+dw3000_irq_rx_frame(dw3000_dev_instance_t * inst)
+{
+    uint32_t finfo;
+    uint32_t aat;
+    uint16_t rxbuf_st = 0;
+    uint16_t rx_len, have = 0;
+    bool rx_clear = false;
+    dw3000_spi_batch_t batch;
+#if MYNEWT_VAL(DW3000_RX_FILTER_MAX)
+    /* Cleared below, a rejected frame restores it */
+    bool rxauto_disable = inst->control.rxauto_disable;
+#endif
+
+    MAC_STATS_INC(DFR_cnt);
+
+    if (inst->uwb_dev.status.overrun_error){
+        MAC_STATS_INC(ROV_err);
+        /* Overrun flag has been set */
+        dw3000_wr_sys_status(inst, SYS_STATUS_RXOVRR |SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR);
+        dw3000_phy_forcetrxoff(inst);
+        dw3000_phy_rx_reset(inst);
+        dw3000_sync_rxbufptrs(inst);
+        dw3000_fast_cmd(inst, DW3000_FCMD_RX);
+        return true;
+    }
 
-        /* Read frame info - Only the first two bytes of the register are used here. */
-        finfo = dw3000_read_reg(inst, RX_FINFO_ID, RX_FINFO_OFFSET, sizeof(uint16_t));
-        /* Report frame length - Standard frame length up to 127,
-         * extended frame length up to 1023 bytes */
-        inst->uwb_dev.frame_len = (finfo & RX_FINFO_RXFL_MASK_1023);
+    // The DW3000 has a bug that render the hardware auto_enable feature useless when used in conjunction with the double buffering.
+    // Consequently, we reenable the transeiver in the MAC-layer as early as possable. Note: The default behavior of MAC-Layer
+    // is that the transceiver only returns to the IDLE state with a timeout event occured. The MAC-layer should otherwise reenable.
 
-        /* Remove the two appended CRC bytes from frame if data is present */
-        if (inst->uwb_dev.frame_len) inst->uwb_dev.frame_len -= 2;
+    if (inst->uwb_dev.config.rxauto_enable == 0 && inst->uwb_dev.config.dblbuffon_enabled) {
+        if (inst->control.rxauto_disable == false && !inst->uwb_dev.status.autoack_triggered) {
+            dw3000_fast_cmd(inst, DW3000_FCMD_RX);
+            inst->uwb_dev.status.rx_restarted = 1;
+        }
+        inst->control.rxauto_disable = false;
+    }
 
-        /* Read the whole frame */
-        dw3000_read_rx(inst, inst->uwb_dev.rxbuf, 0,
-                       (inst->uwb_dev.frame_len < inst->uwb_dev.rxbuf_size) ?
-                       inst->uwb_dev.frame_len : inst->uwb_dev.rxbuf_size);
+    /* Read frame info */
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+    if (inst->irq_th.valid) {
+        finfo = dw3000_irq_capture_value(inst->irq_th.rx_finfo, RX_FINFO_LEN);
+    } else
+#endif
+    {
+        finfo = dw3000_rd_rx_finfo(inst);
+    }
+    /* Report frame length - Standard frame length up to 127,
+     * extended frame length up to 1023 bytes */
+    inst->uwb_dev.frame_len = (finfo & RX_FINFO_RXFL_MASK_1023);
 
-        /* First two bytes are frame ctrl */
-        inst->uwb_dev.fctrl = ((uint16_t)inst->uwb_dev.rxbuf[1]<<8) | inst->uwb_dev.rxbuf[0];
+    /* Remove the two appended CRC bytes from frame if data is present */
+    if (inst->uwb_dev.frame_len) {
+        inst->uwb_dev.frame_len -= 2;
+    }
+    rx_len = (inst->uwb_dev.frame_len < inst->uwb_dev.rxbuf_size) ?
+        inst->uwb_dev.frame_len : inst->uwb_dev.rxbuf_size;
 
-#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)
-        if(!inst->sys_status_bt_lock) {
-            DW3000_SYS_STATUS_BT_FCTRL(inst, inst->uwb_dev.fctrl);
-        }
+#if MYNEWT_VAL(DW3000_RX_FILTER_MAX)
+    /* Run the software frame filter on the header, a rejected frame is released
+     * without reading the rest of it or calling any callback */
+    if (!dw3000_rx_filter_run(inst, rx_len, &have)) {
+        inst->uwb_dev.fctrl = (have < sizeof(uint16_t)) ? 0 :
+            ((uint16_t)inst->uwb_dev.rxbuf[1]<<8) | inst->uwb_dev.rxbuf[0];
+        dw3000_rx_filter_reject(inst, rxauto_disable);
+        return false;
+    }
 #endif
 
-        if (inst->uwb_dev.status.lde_error) // retest lde_error condition
-            inst->uwb_dev.status.lde_error = (dw3000_read_reg(inst, SYS_STATUS_ID, 1, sizeof(uint8_t))  & (SYS_STATUS_LDEDONE >> 8)) == 0;
-        if (inst->uwb_dev.status.lde_error) // LDE error or LDE late
-            MAC_STATS_INC(LDE_err);
-
-        inst->uwb_dev.rxtimestamp = dw3000_read_rxtime(inst);
-        if (inst->control.abs_timeout) {
-            update_rx_window_timeout(inst, inst->uwb_dev.rxtimestamp);
+#if MYNEWT_VAL(DW3000_RX_LAZY_HDR)
+    inst->rx_frame_len = inst->uwb_dev.frame_len;
+    if (inst->rx_hdr_cb) {
+        dw3000_rx_read_lazy(inst, have);
+    } else {
+        inst->rx_fetched = rx_len;
+        if (rx_len > have) {
+            dw3000_read_rx(inst, inst->uwb_dev.rxbuf + have, have, rx_len - have);
         }
+    }
+#else
+    /* Read the rest of the frame */
+    if (rx_len > have) {
+        dw3000_read_rx(inst, inst->uwb_dev.rxbuf + have, have, rx_len - have);
+    }
+#endif
 
-        if (inst->uwb_dev.status.autoack_triggered) {
-            /* Because of a previous frame not being received properly, AAT bit can be set upon the proper reception of a frame not requesting for
-             * acknowledgement (ACK frame is not actually sent though). If the AAT bit is set, check ACK request bit in frame control to confirm (this
-             * implementation works only for IEEE802.15.4-2011 compliant frames).
-             * This issue is not documented at the time of writing this code. It should be in next release of DW3000 User Manual (v2.09, from July 2016). */
-            if ((inst->uwb_dev.fctrl & UWB_FCTRL_ACK_REQUESTED) == 0){
-                /* Clear AAT status bit in callback data register copy and status */
-                dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_AAT, sizeof(uint8_t));
-                inst->sys_status &= ~SYS_STATUS_AAT;
-                inst->uwb_dev.status.autoack_triggered = 0;
-            } else {
-                /* Clear RX flags in sys_status */
-                dw3000_write_reg(inst, SYS_STATUS_ID, 1, (inst->sys_status&(SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR))>>8, sizeof(uint8_t));
-            }
-        }
+    /* First two bytes are frame ctrl */
+    inst->uwb_dev.fctrl = ((uint16_t)inst->uwb_dev.rxbuf[1]<<8) | inst->uwb_dev.rxbuf[0];
 
-        // Collect RX Frame Quality diagnositics
-        if(inst->uwb_dev.config.rxdiag_enable)
-            dw3000_read_rxdiag(inst, &inst->rxdiag);
+#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)
+    if(!inst->sys_status_bt_lock) {
+        DW3000_SYS_STATUS_BT_FCTRL(inst, inst->uwb_dev.fctrl);
+    }
+#endif
 
-        // Toggle the Host side Receive Buffer Pointer
+    /* Retest lde_error condition and fetch the timestamp in one bus transaction. In double
+     * buffer mode everything else still needed from the host side buffer set, and the status
+     * byte holding the overrun flag and buffer pointers, is read in the same transaction so
+     * that the buffers can be swapped right after */
+    {
+        int lde_idx = -1, ts_idx = -1, ttcko_idx = -1, st_idx = -1;
+        dw3000_spi_batch_init(&batch);
+        if (inst->uwb_dev.status.lde_error) {
+            lde_idx = dw3000_spi_batch_read_reg(&batch, SYS_STATUS_ID, 1, sizeof(uint8_t));
+        }
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+        /* Timestamp captured by the interrupt top half */
+        if (inst->irq_th.valid) {
+            inst->uwb_dev.rxtimestamp = dw3000_irq_capture_value(inst->irq_th.rx_stamp, RX_TIME_RX_STAMP_LEN) & 0x0FFFFFFFFFFULL;
+        } else
+#endif
+        {
+            ts_idx = dw3000_spi_batch_read_reg(&batch, RX_TIME_ID, RX_TIME_RX_STAMP_OFFSET, RX_TIME_RX_STAMP_LEN);
+        }
         if (inst->uwb_dev.config.dblbuffon_enabled) {
+            if (inst->uwb_dev.config.rxdiag_enable) {
+                dw3000_spi_batch_read(&batch, RX_TIME_ID, RX_TIME_FP_INDEX_OFFSET, (uint8_t*)&inst->rxdiag.rx_time, sizeof(inst->rxdiag.rx_time));
+                dw3000_spi_batch_read(&batch, RX_FQUAL_ID, 0, (uint8_t*)&inst->rxdiag.rx_fqual, sizeof(inst->rxdiag.rx_fqual));
+                inst->rxdiag.pacc_cnt = (finfo & RX_FINFO_RXPACC_MASK) >> RX_FINFO_RXPACC_SHIFT;
+            }
             // The rxttcko is a poor replacement for the carrier_integrator but
             // better than nothing
             if (inst->uwb_dev.config.rxttcko_enable) {
-                inst->uwb_dev.rxttcko = dw3000_read_time_tracking_offset(inst);
-            }
-
-            inst->uwb_dev.status.overrun_error = dw3000_checkoverrun(inst);
-            if (inst->uwb_dev.status.overrun_error == 0) {
-                /* Check where the receiver is at, and if it's in the same buffer as we are,
-                 * mask out interrupt flags to avoid spurious interrupts when clearing status bits */
-                if (inst->uwb_dev.config.rxauto_enable) {
-                    if (dw3000_ic_and_host_ptrs_equal(inst)) {
-                        uint8_t mask = dw3000_read_reg(inst, SYS_MASK_ID, 1 , sizeof(uint8_t));
-                        dw3000_write_reg(inst, SYS_MASK_ID, 1, 0, sizeof(uint8_t));
-                        dw3000_write_reg(inst, SYS_STATUS_ID, 1, (inst->sys_status&(SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR))>>8, sizeof(uint8_t));
-                        dw3000_write_reg(inst, SYS_MASK_ID, 1, mask, sizeof(uint8_t));
-                    } else {
-                        dw3000_write_reg(inst, SYS_STATUS_ID, 1, (inst->sys_status&(SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR))>>8, sizeof(uint8_t));
-                    }
-                }
-                /* Swap buffers */
-                dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_HRBT_OFFSET , 0b1, sizeof(uint8_t));
-            }else{
-                MAC_STATS_INC(ROV_err);
-                /* Overrun flag has been set, reset receiver and realign buffers */
-                dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_RXOVRR, sizeof(uint32_t));
-                dw3000_phy_forcetrxoff(inst);
-                dw3000_phy_rx_reset(inst);
-                dw3000_sync_rxbufptrs(inst);
-                dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-            }
-        }else{
-            // carrier_integrator only avilable while in single buffer mode.
-            inst->uwb_dev.carrier_integrator = dw3000_read_carrier_integrator(inst);
-#if MYNEWT_VAL(CIR_ENABLED)
-            // Call CIR complete calbacks if present
-            if(inst->uwb_dev.config.cir_enable || inst->control.cir_enable) {
-                if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))) {
-                    SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next) {
-                        if (cbs != NULL && cbs->cir_complete_cb) {
-                            if(cbs->cir_complete_cb((struct uwb_dev*)inst,cbs)) continue;
-                        }
-                    }
-                }
-                inst->control.cir_enable = false;
-            }
-#endif
-            dw3000_write_reg(inst, SYS_STATUS_ID, 0,
-                             inst->sys_status & (SYS_STATUS_LDEDONE | SYS_STATUS_RXPHD | SYS_STATUS_RXDFR |
-                                                 SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR),
-                             sizeof(uint16_t));
-            if (inst->control.rxauto_disable == false){
-                dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-                inst->uwb_dev.status.rx_restarted = 1;
+                ttcko_idx = dw3000_spi_batch_read_reg(&batch, RX_TTCKO_ID, 0, 3);
             }
-            inst->control.rxauto_disable = false;
+            /* RXOVRR in byte 2, ICRBP and HSRBP in byte 3 */
+            st_idx = dw3000_spi_batch_read_reg(&batch, SYS_STATUS_ID, 2, sizeof(uint16_t));
+        }
+        if (batch.count) {
+            dw3000_spi_batch_submit(inst, &batch);
+        }
 
+        if (lde_idx >= 0) {
+            inst->uwb_dev.status.lde_error = (dw3000_spi_batch_value(&batch, lde_idx) & (SYS_STATUS_LDEDONE >> 8)) == 0;
         }
+        if (ts_idx >= 0) {
+            inst->uwb_dev.rxtimestamp = dw3000_spi_batch_value(&batch, ts_idx) & 0x0FFFFFFFFFFULL;
+        }
+        if (ttcko_idx >= 0) {
+            inst->uwb_dev.rxttcko = dw3000_ttcko_sign_extend(dw3000_spi_batch_value(&batch, ttcko_idx));
+        }
+        if (st_idx >= 0) {
+            rxbuf_st = dw3000_spi_batch_value(&batch, st_idx);
+        }
+    }
+    if (inst->uwb_dev.status.lde_error) { // LDE error or LDE late
+        MAC_STATS_INC(LDE_err);
+    }
 
-        // Call the corresponding frame services callback if present
-        if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-            SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs != NULL && cbs->rx_complete_cb)
-                if(cbs->rx_complete_cb((struct uwb_dev*)inst,cbs)) continue;
-            }
+    if (inst->control.abs_timeout) {
+        update_rx_window_timeout(inst, inst->uwb_dev.rxtimestamp);
+    }
+
+    aat = dw3000_rx_aat(inst, &rx_clear);
+
+    // Collect RX Frame Quality diagnositics, read above in double buffer mode
+    if (inst->uwb_dev.config.rxdiag_enable && !inst->uwb_dev.config.dblbuffon_enabled) {
+        dw3000_read_rxdiag(inst, &inst->rxdiag);
+    }
+
+    if (!inst->uwb_dev.config.dblbuffon_enabled) {
+        // carrier_integrator only avilable while in single buffer mode.
+        inst->uwb_dev.carrier_integrator = dw3000_read_carrier_integrator(inst);
+#if MYNEWT_VAL(CIR_ENABLED)
+        // Call CIR complete calbacks if present
+        if(inst->uwb_dev.config.cir_enable || inst->control.cir_enable) {
+            dw3000_mac_interface_dispatch(inst, DW3000_CB_CIR_COMPLETE, false);
+            inst->control.cir_enable = false;
         }
+#endif
     }
+    dw3000_rx_release(inst, rxbuf_st, aat, rx_clear, false);
 
-    // Handle TX Frame Begins
-    if(inst->sys_status & SYS_STATUS_TXFRB) {
-        // Call the corresponding callback if present
-        dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_TXFRB, sizeof(uint8_t)); // Clear TX Frame Begins
+#if MYNEWT_VAL(DW3000_RX_RING_LEN)
+    /* The attached consumer task gets the frame instead of rx_complete_cb */
+    if (inst->rx_ring_attached) {
+        dw3000_rx_ring_put(inst);
+        return false;
+    }
+#endif
 
-        if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-            SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs!=NULL && cbs->tx_begins_cb)
-                if(cbs->tx_begins_cb((struct uwb_dev*)inst,cbs)) break;
-            }
+    // Call the corresponding frame services callback if present
+#if MYNEWT_VAL(DW3000_RX_DEMUX_MAX)
+    {
+        struct uwb_mac_interface * owner;
+        if (dw3000_rx_demux(inst, &owner)) {
+            return false;
         }
+        /* Declined by the owner, offered to the others */
+        dw3000_mac_interface_dispatch_skip(inst, DW3000_CB_RX_COMPLETE, false, owner);
     }
+#else
+    dw3000_mac_interface_dispatch(inst, DW3000_CB_RX_COMPLETE, false);
+#endif
+    return false;
+}
+
+/**
+ * TX frame begins event, TXFRB.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return bool true if the remaining events are to be skipped
+ */
+static bool
+dw3000_irq_tx_begins(dw3000_dev_instance_t * inst)
+{
 
-    // Handle TX confirmation event
-    if(inst->sys_status & SYS_STATUS_TXFRS) {
-        MAC_STATS_INC(TFG_cnt);
+    // Call the corresponding callback if present
+    dw3000_mac_interface_dispatch(inst, DW3000_CB_TX_BEGINS, true);
+    return false;
+}
 
-        dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_ALL_TX, sizeof(uint8_t)); // Clear TX event bits
+/**
+ * TX confirmation event, TXFRS.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return bool true if the remaining events are to be skipped
+ */
+static bool
+dw3000_irq_tx_done(dw3000_dev_instance_t * inst)
+{
+    dpl_error_t err;
+    dw3000_spi_batch_t batch;
 
-        if (inst->control.abs_timeout) {
-            dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-            update_rx_window_timeout(inst, dw3000_read_txtime(inst));
-        }
+    MAC_STATS_INC(TFG_cnt);
 
-        if(dpl_sem_get_count(&inst->tx_sem) == 0){
-            err = dpl_sem_release(&inst->tx_sem);
-            assert(err == DPL_OK);
-        }
+    if (inst->control.abs_timeout) {
+        int ts_idx;
+        dw3000_spi_batch_init(&batch);
+        dw3000_spi_batch_write_reg(&batch, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
+        ts_idx = dw3000_spi_batch_read_reg(&batch, TX_TIME_ID, TX_TIME_TX_STAMP_OFFSET, TX_TIME_TX_STAMP_LEN);
+        dw3000_spi_batch_submit(inst, &batch);
+        update_rx_window_timeout(inst, dw3000_spi_batch_value(&batch, ts_idx) & 0x0FFFFFFFFFFULL);
+    }
+
+    if(dpl_sem_get_count(&inst->tx_sem) == 0){
+        err = dpl_sem_release(&inst->tx_sem);
+        assert(err == DPL_OK);
+    }
 
 #if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)
-        if(!inst->sys_status_bt_lock && !inst->uwb_dev.status.autoack_triggered) {
-            /* Assuming the start_tx writes the fctrl at send time */
-            DW3000_SYS_STATUS_BT_FCTRL(inst, inst->uwb_dev.fctrl);
-        }
+    if(!inst->sys_status_bt_lock && !inst->uwb_dev.status.autoack_triggered) {
+        /* Assuming the start_tx writes the fctrl at send time */
+        DW3000_SYS_STATUS_BT_FCTRL(inst, inst->uwb_dev.fctrl);
+    }
 #endif
 
-        // Call the corresponding callback if present
-        if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-            SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs!=NULL && cbs->tx_complete_cb)
-                if(cbs->tx_complete_cb((struct uwb_dev*)inst,cbs)) break;
-            }
-        }
+    // Call the corresponding callback if present
+    dw3000_mac_interface_dispatch(inst, DW3000_CB_TX_COMPLETE, true);
+    return false;
+}
+
+/**
+ * TX buffer error event, TXBERR.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return bool true if the remaining events are to be skipped
+ */
+static bool
+dw3000_irq_txbuf_err(dw3000_dev_instance_t * inst)
+{
+    dpl_error_t err;
+
+    MAC_STATS_INC(TXBUF_err);
+    if(dpl_sem_get_count(&inst->tx_sem) == 0){
+        err = dpl_sem_release(&inst->tx_sem);
+        assert(err == DPL_OK);
     }
-    // Tx buffer error
-    if(inst->uwb_dev.status.txbuf_error){
-        MAC_STATS_INC(TXBUF_err);
-        dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_TXBERR, sizeof(uint32_t));
-        if(dpl_sem_get_count(&inst->tx_sem) == 0){
-            err = dpl_sem_release(&inst->tx_sem);
-            assert(err == DPL_OK);
+    return false;
+}
+
+/**
+ * Leading edge detection error event, LDEERR.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return bool true if the remaining events are to be skipped
+ */
+static bool
+dw3000_irq_lde_err(dw3000_dev_instance_t * inst)
+{
+    MAC_STATS_INC(LDE_err);
+    return false;
+}
+
+/**
+ * Frame reception and preamble detect timeout events, RXRFTO and RXPTO.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return bool true if the remaining events are to be skipped
+ */
+static bool
+dw3000_irq_rx_timeout(dw3000_dev_instance_t * inst)
+{
+
+    MAC_STATS_INC(RTO_cnt);
+
+    if (inst->control.abs_timeout) {
+        /* Absolute timeout active, reactivate receiver if there's still time left */
+        uint64_t systime = dw3000_read_systime(inst);
+        uint32_t new_timeout = calc_rx_window_timeout(systime, inst->uwb_dev.abs_timeout);
+        if (new_timeout > 1) {
+            dw3000_fast_cmd(inst, DW3000_FCMD_RX);
+            dw3000_adj_rx_timeout(inst, new_timeout);
+        } else {
+            inst->control.abs_timeout = false;
         }
     }
 
-    // leading edge detection complete
-    if(inst->sys_status & SYS_STATUS_LDEERR){
-        MAC_STATS_INC(LDE_err);
-        dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_LDEERR, sizeof(uint32_t));
-    }
+    if (!inst->control.abs_timeout) {
+        // Because of an issue with receiver restart after error conditions, an RX reset must be applied
+        // after any error or timeout event to ensure the next good frame's timestamp is computed correctly.
+        // See section "RX Message timestamp" in DW3000 User Manual.
+        dw3000_fast_cmd(inst, DW3000_FCMD_TRXOFF); // Disable the radio
+        dw3000_phy_rx_reset(inst);
 
-    // Handle frame reception/preamble detect timeout events
-    if(inst->uwb_dev.status.rx_timeout_error){
-        MAC_STATS_INC(RTO_cnt);
-        dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_ALL_RX_TO, sizeof(uint32_t)); // Clear RX timeout event bits
+        inst->control.cir_enable = false;
+        inst->control.rxauto_disable = false;
+        inst->control.abs_timeout = false;
 
-        if (inst->control.abs_timeout) {
-            /* Absolute timeout active, reactivate receiver if there's still time left */
-            uint64_t systime = dw3000_read_systime(inst);
-            uint32_t new_timeout = calc_rx_window_timeout(systime, inst->uwb_dev.abs_timeout);
-            if (new_timeout > 1) {
-                dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-                dw3000_adj_rx_timeout(inst, new_timeout);
-            } else {
-                inst->control.abs_timeout = false;
-            }
-        }
+        // Call the corresponding frame services callback if present
+        dw3000_mac_interface_dispatch(inst, DW3000_CB_RX_TIMEOUT, false);
+    }
+    return false;
+}
 
-        if (!inst->control.abs_timeout) {
-            // Because of an issue with receiver restart after error conditions, an RX reset must be applied
-            // after any error or timeout event to ensure the next good frame's timestamp is computed correctly.
-            // See section "RX Message timestamp" in DW3000 User Manual.
-            dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint16_t)SYS_CTRL_TRXOFF, sizeof(uint16_t)) ; // Disable the radio
-            dw3000_phy_rx_reset(inst);
+/**
+ * Receive error events, RXPHE, RXFCE, RXRFSL, RXSFDTO, AFFREJ, LDEERR and RXRSCS.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return bool true if the remaining events are to be skipped
+ */
+static bool
+dw3000_irq_rx_err(dw3000_dev_instance_t * inst)
+{
 
-            inst->control.cir_enable = false;
-            inst->control.rxauto_disable = false;
-            inst->control.abs_timeout = false;
+    MAC_STATS_INC(RX_err);
 
-            // Call the corresponding frame services callback if present
-            if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-                SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-                    if (cbs!=NULL && cbs->rx_timeout_cb)
-                        if(cbs->rx_timeout_cb((struct uwb_dev*)inst,cbs)) continue;
-                }
-            }
-        }
+    // Because of an issue with receiver restart after error conditions, an RX reset must be applied after any error or timeout event to ensure
+    // the next good frame's timestamp is computed correctly.
+    // See section "RX Message timestamp" in DW3000 User Manual.
+
+    if (inst->uwb_dev.config.dblbuffon_enabled && inst->uwb_dev.status.overrun_error) {
+        MAC_STATS_INC(ROV_err);
+        dw3000_phy_rx_reset(inst);
+        dw3000_fast_cmd(inst, DW3000_FCMD_HRBT);
+        dw3000_sync_rxbufptrs(inst);
+    } else {
+        dw3000_fast_cmd(inst, DW3000_FCMD_TRXOFF);
+        dw3000_phy_rx_reset(inst);
+    }
+    /* Restart the receiver even if rxauto is not enabled. Timeout remain active if set.
+     * NOTE: Because we reset the receiver explicitly above we will need to reenable
+     * the receiver even though the auto-enable is on. */
+    dw3000_fast_cmd(inst, DW3000_FCMD_RX);
+    if (inst->control.abs_timeout) {
+        update_rx_window_timeout(inst, dw3000_read_systime(inst));
     }
 
-    // Handle RX errors events
-    if(inst->uwb_dev.status.rx_error) {
-        MAC_STATS_INC(RX_err);
+    // Call the corresponding frame services callback if present
+    dw3000_mac_interface_dispatch(inst, DW3000_CB_RX_ERROR, false);
+    return false;
+}
 
-        // Because of an issue with receiver restart after error conditions, an RX reset must be applied after any error or timeout event to ensure
-        // the next good frame's timestamp is computed correctly.
-        // See section "RX Message timestamp" in DW3000 User Manual.
+/**
+ * Clock PLL losing lock event, CLKPLL_LL.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return bool true if the remaining events are to be skipped
+ */
+static bool
+dw3000_irq_pll_ll(dw3000_dev_instance_t * inst)
+{
+    MAC_STATS_INC(PLL_LL_err);
+    return false;
+}
 
-        dw3000_write_reg(inst, SYS_STATUS_ID, 0, (SYS_STATUS_ALL_RX_ERR), sizeof(uint32_t)); // Clear RX error event bits
+/**
+ * Clock PLL lock event, CPLOCK, the device has woken up.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return bool true if the remaining events are to be skipped
+ */
+static bool
+dw3000_irq_pll_lock(dw3000_dev_instance_t * inst)
+{
 
-        if (inst->uwb_dev.config.dblbuffon_enabled && inst->uwb_dev.status.overrun_error) {
-            MAC_STATS_INC(ROV_err);
-            dw3000_phy_rx_reset(inst);
-            dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_HRBT_OFFSET, 0b1, sizeof(uint8_t));
-            dw3000_sync_rxbufptrs(inst);
-        } else {
-            dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint8_t) SYS_CTRL_TRXOFF, sizeof(uint8_t));
-            dw3000_phy_rx_reset(inst);
-        }
-        /* Restart the receiver even if rxauto is not enabled. Timeout remain active if set.
-         * NOTE: Because we reset the receiver explicitly above we will need to reenable
-         * the receiver even though the auto-enable is on. */
-        dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-        if (inst->control.abs_timeout) {
-            update_rx_window_timeout(inst, dw3000_read_systime(inst));
-        }
+    dw3000_clk_event(inst, DW3000_CLK_EV_PLL_LOCK);
+    dw3000_shadow_invalidate(inst);
 
-        // Call the corresponding frame services callback if present
-        if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-            SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs!=NULL && cbs->rx_error_cb)
-                if(cbs->rx_error_cb((struct uwb_dev*)inst,cbs)) continue;
+    // restore antenna delay value, these are not preserved during sleep/deepsleep */
+    dw3000_phy_set_rx_antennadelay(inst, inst->uwb_dev.rx_antenna_delay);
+    dw3000_phy_set_tx_antennadelay(inst, inst->uwb_dev.tx_antenna_delay);
+
+    // Call the corresponding callback if present
+    inst->uwb_dev.status.sleeping = 0;
+    dw3000_mac_interface_dispatch(inst, DW3000_CB_SLEEP, false);
+    return false;
+}
+
+//! Interrupt event, see dw3000_irq_events
+typedef struct _dw3000_irq_event_t{
+    uint32_t status;                                //!< SYS_STATUS bits raising the event
+    uint8_t status_hi;                              //!< SYS_STATUS high byte bits raising the event
+    uint32_t clear;                                 //!< Bits acknowledged in the coalesced clear, 0 if the handler clears itself
+    bool (* handler)(dw3000_dev_instance_t * inst); //!< Event handler, returns true to skip the remaining events
+} dw3000_irq_event_t;
+
+/**
+ * Interrupt events in order of processing. The clear bits of all raised events are
+ * collected and written to SYS_STATUS in a single write, just before the first
+ * handler that relies on it. Events that have to clear at a particular point, before
+ * re-enabling the receiver or swapping buffers, come first and clear themselves.
+ */
+static const dw3000_irq_event_t dw3000_irq_events[] = {
+    {SYS_STATUS_RXFCG,      0,                      0,                      dw3000_irq_rx_frame},
+    {SYS_STATUS_TXFRB,      0,                      SYS_STATUS_TXFRB,       dw3000_irq_tx_begins},
+    {SYS_STATUS_TXFRS,      0,                      SYS_STATUS_ALL_TX,      dw3000_irq_tx_done},
+    {SYS_STATUS_TXBERR,     0,                      SYS_STATUS_TXBERR,      dw3000_irq_txbuf_err},
+    {SYS_STATUS_LDEERR,     0,                      SYS_STATUS_LDEERR,      dw3000_irq_lde_err},
+    {SYS_STATUS_ALL_RX_TO,  0,                      SYS_STATUS_ALL_RX_TO,   dw3000_irq_rx_timeout},
+    {SYS_STATUS_ALL_RX_ERR, SYS_STATUS_RXRSCS>>32,  SYS_STATUS_ALL_RX_ERR,  dw3000_irq_rx_err},
+    {SYS_STATUS_SLP2INIT,   0,                      SYS_STATUS_SLP2INIT,    NULL},
+    {SYS_STATUS_CLKPLL_LL,  0,                      SYS_STATUS_CLKPLL_LL,   dw3000_irq_pll_ll},
+    {SYS_STATUS_CPLOCK,     0,                      SYS_STATUS_CPLOCK,      dw3000_irq_pll_lock},
+};
+
+/**
+ * Read SYS_STATUS, or take it from the interrupt top half, and dispatch the raised events.
+ *
+ * @param inst  Pointer to dw3000_dev_instance_t.
+ * @return void
+ */
+static void
+dw3000_interrupt_process(dw3000_dev_instance_t * inst)
+{
+    uint32_t clear = 0;
+    uint32_t raised = 0;
+
+    /* Read status register */
+#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)
+    {
+        uint32_t irq_utime = dpl_cputime_get32();
+#endif
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+        if (inst->irq_th.valid) {
+            /* Captured by the interrupt top half, high status bits included */
+            inst->sys_status = dw3000_irq_capture_value(inst->irq_th.sys_status, sizeof(uint32_t));
+            inst->sys_status_hi = inst->irq_th.sys_status[4];
+        } else
+#endif
+        {
+            inst->sys_status = dw3000_rd_sys_status(inst);
+            /* Check for higher status bits only if needed */
+            if (!(inst->sys_status & (SYS_MASK_MCPLOCK | SYS_MASK_MRXDFR | SYS_MASK_MLDEERR | SYS_MASK_MTXFRB | SYS_MASK_MTXFRS | SYS_MASK_ALL_RX_TO | SYS_MASK_ALL_RX_ERR | SYS_MASK_MTXBERR))) {
+                inst->sys_status_hi = dw3000_rd_sys_status_hi(inst);
             }
         }
+
+        DW3000_TRACE(inst, DW3000_TRACE_IRQ, inst->sys_status_hi, 0, inst->sys_status);
+#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_LEN)
+        if(!inst->sys_status_bt_lock) {
+            DW3000_SYS_STATUS_BT_ADD(inst, inst->sys_status, irq_utime);
+#if MYNEWT_VAL(DW3000_SYS_STATUS_BACKTRACE_HI)
+            DW3000_SYS_STATUS_BT_HI(inst, inst->sys_status_hi);
+#endif
+        }
     }
+#endif
+
+    // Set status flags
+    inst->uwb_dev.status.rx_error = (inst->sys_status & SYS_STATUS_ALL_RX_ERR) !=0;
+    inst->uwb_dev.status.rx_error |= (inst->sys_status_hi & (SYS_STATUS_RXRSCS>>32)) != 0;
+    inst->uwb_dev.status.rx_autoframefilt_rej = (inst->sys_status & SYS_STATUS_AFFREJ) !=0;
+    inst->uwb_dev.status.rx_timeout_error = (inst->sys_status & SYS_STATUS_ALL_RX_TO) !=0;
+    inst->uwb_dev.status.lde_error = (inst->sys_status & SYS_STATUS_LDEDONE) == 0;
+    inst->uwb_dev.status.overrun_error = (inst->sys_status & SYS_STATUS_RXOVRR) != 0;
+    inst->uwb_dev.status.txbuf_error = (inst->sys_status & SYS_STATUS_TXBERR) != 0;
+    inst->uwb_dev.status.autoack_triggered = (inst->sys_status & SYS_STATUS_AAT) != 0;
+    inst->uwb_dev.status.rx_prej = (inst->sys_status_hi & (SYS_STATUS_RXPREJ>>32)) != 0;
 
-    /* Clear SLP2INIT event bits */
-    if(inst->sys_status & SYS_STATUS_SLP2INIT){
-        dw3000_write_reg(inst, SYS_STATUS_ID, 2, SYS_STATUS_SLP2INIT>>16, 1);
+    /* Clear tx_sem unless this is a TXFRB and not TXFRS */
+    if(dpl_sem_get_count(&inst->tx_sem) == 0 && !(
+           (inst->sys_status & SYS_STATUS_TXFRB) != 0 &&
+           (inst->sys_status & SYS_STATUS_TXFRS) == 0
+           )) {
+        dpl_error_t err = dpl_sem_release(&inst->tx_sem);
+        assert(err == DPL_OK);
     }
 
-    // Handle sleep timer event
-    if(inst->sys_status & SYS_STATUS_CLKPLL_LL){
-        dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_CLKPLL_LL, sizeof(uint32_t));
-        MAC_STATS_INC(PLL_LL_err);
+    for (int i = 0;i < sizeof(dw3000_irq_events)/sizeof(dw3000_irq_events[0]);i++) {
+        const dw3000_irq_event_t * e = &dw3000_irq_events[i];
+        if ((inst->sys_status & e->status) || (inst->sys_status_hi & e->status_hi)) {
+            raised |= (1UL << i);
+            clear |= inst->sys_status & e->clear;
+        }
     }
-    // Handle sleep timer event
-    if(inst->sys_status & SYS_MASK_MCPLOCK){
-        dw3000_write_reg(inst, SYS_STATUS_ID, 0, SYS_MASK_MCPLOCK, sizeof(uint32_t));
 
-        // restore antenna delay value, these are not preserved during sleep/deepsleep */
-        dw3000_phy_set_rx_antennadelay(inst, inst->uwb_dev.rx_antenna_delay);
-        dw3000_phy_set_tx_antennadelay(inst, inst->uwb_dev.tx_antenna_delay);
+    for (int i = 0;i < sizeof(dw3000_irq_events)/sizeof(dw3000_irq_events[0]);i++) {
+        const dw3000_irq_event_t * e = &dw3000_irq_events[i];
+        if (!(raised & (1UL << i))) {
+            continue;
+        }
+        if (e->clear && clear) {
+            /* Acknowledge all remaining events at once */
+            dw3000_wr_sys_status(inst, clear);
+            clear = 0;
+        }
+        if (e->handler && e->handler(inst)) {
+            break;
+        }
+    }
+}
 
-        // Call the corresponding callback if present
-        inst->uwb_dev.status.sleeping = 0;
-        if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-            SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs!=NULL && cbs->sleep_cb)
-                if (cbs->sleep_cb((struct uwb_dev*)inst,cbs)) continue;
-            }
+/**
+ * This is the DW3000's general Interrupt Service Routine. It will process/report the following events:
+ *          - RXFCG (through rx_complete_cb callback)
+ *          - TXFRS (through tx_complete_cb callback)
+ *          - RXRFTO/RXPTO (through rx_timeout_cb callback)
+ *          - RXPHE/RXFCE/RXRFSL/RXSFDTO/AFFREJ/LDEERR (through rx_error_cb cbRxErr)
+ * Events are dispatched through dw3000_irq_events. Their status bits are cleared with a single
+ * write, except for a received frame whose status is cleared together with the receiver restart.
+ * In the RXFCG case, received frame information and frame control are read before calling the
+ * callback. If double buffering is activated, it will also toggle between reception buffers once
+ * the reception callback processing has ended.
+ *
+ * @param ev  Pointer to the queue of events.
+ * @return void
+ *
+ */
+static void
+dw3000_interrupt_ev_cb(struct dpl_event *ev)
+{
+    dw3000_dev_instance_t * inst = dpl_event_get_arg(ev);
+    dpl_error_t err = dpl_sem_pend(&inst->uwb_dev.irq_sem,  DPL_TIMEOUT_NEVER);
+    if (err != DPL_OK) {
+        inst->uwb_dev.status.sem_error = 1;
+        goto sem_error_exit;
+    }
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+    if (inst->irq_poll.active && !hal_gpio_read(inst->irq_pin)) {
+        /* Nothing pending, skip the status read */
+        dw3000_irq_poll_idle(inst);
+        dpl_sem_release(&inst->uwb_dev.irq_sem);
+        return;
+    }
+#endif
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+    {
+        os_sr_t sr;
+        DPL_ENTER_CRITICAL(sr);
+        if (inst->irq_th.state == DW3000_IRQ_TH_CAPTURE) {
+            /* Capture in flight, its completion queues the bottom half again */
+            DPL_EXIT_CRITICAL(sr);
+            dpl_sem_release(&inst->uwb_dev.irq_sem);
+            return;
+        }
+        inst->irq_th.valid = (inst->irq_th.state == DW3000_IRQ_TH_READY);
+        inst->irq_th.state = DW3000_IRQ_TH_BUSY;
+        DPL_EXIT_CRITICAL(sr);
+    }
+#endif
+    /* Transfers from this task, callbacks included, win bus arbitration */
+    inst->spi_irq_task = dpl_get_current_task_id();
+
+    dw3000_interrupt_process(inst);
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+    if (inst->irq_poll.active) {
+        /* Drain the events that arrived since, within the batch limit */
+        inst->irq_poll.idle = 0;
+        for (int i = 1;i < MYNEWT_VAL(DW3000_IRQ_POLL_BATCH) && hal_gpio_read(inst->irq_pin);i++) {
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+            inst->irq_th.valid = 0;
+#endif
+            MAC_STATS_INC(POLL_drain);
+            dw3000_interrupt_process(inst);
         }
     }
+#endif
 
-early_exit:
+    DW3000_TRACE(inst, DW3000_TRACE_IRQ_END, 0, 0, 0);
+    inst->spi_irq_task = NULL;
+#if MYNEWT_VAL(DW3000_IRQ_TOP_HALF)
+    /* Let the next interrupt start a new capture */
+    inst->irq_th.valid = 0;
+    inst->irq_th.state = DW3000_IRQ_TH_IDLE;
+#endif
     dpl_sem_release(&inst->uwb_dev.irq_sem);
+#if MYNEWT_VAL(DW3000_IRQ_POLL_RATE)
+    dw3000_irq_poll_update(inst);
+    if (inst->irq_poll.active) {
+        /* Remaining events are picked up by the next poll */
+        return;
+    }
+#endif
 sem_error_exit:
     /* Check for possibly missed interrupts occuring whilst we were looking at this one
      * NOTE: Because the interrupt is edge based we will only register an event if the irq pin
@@ -1973,7 +3413,7 @@ dw3000_estimate_los(dpl_float32_t rssi, dpl_float32_t fppl)
  * @return time
  */
 inline uint64_t dw3000_read_systime(struct _dw3000_dev_instance_t * inst){
-    uint64_t time = ((uint64_t) dw3000_read_reg(inst, SYS_TIME_ID, SYS_TIME_OFFSET, SYS_TIME_LEN)) & 0x0FFFFFFFFFFULL;
+    uint64_t time = ((uint64_t) dw3000_rd_sys_time(inst)) & 0x0FFFFFFFFFFULL;
     return time;
 }
 
@@ -1986,7 +3426,7 @@ inline uint64_t dw3000_read_systime(struct _dw3000_dev_instance_t * inst){
  * @return time
  */
 inline uint32_t dw3000_read_systime_lo(struct _dw3000_dev_instance_t * inst){
-    uint32_t time = (uint32_t) dw3000_read_reg(inst, SYS_TIME_ID, SYS_TIME_OFFSET, sizeof(uint32_t));
+    uint32_t time = (uint32_t) dw3000_rd_sys_time_lo32(inst);
     return time;
 }
 
@@ -1999,7 +3439,7 @@ inline uint32_t dw3000_read_systime_lo(struct _dw3000_dev_instance_t * inst){
  */
 
 uint64_t dw3000_read_rawrxtime(struct _dw3000_dev_instance_t * inst){
-    uint64_t time = (uint64_t)  dw3000_read_reg(inst, RX_TIME_ID, RX_TIME_FP_RAWST_OFFSET, RX_TIME_RX_STAMP_LEN) & 0x0FFFFFFFFFFULL;
+    uint64_t time = (uint64_t)  dw3000_rd_rx_rawst(inst) & 0x0FFFFFFFFFFULL;
     return time;
 }
 
@@ -2012,7 +3452,7 @@ uint64_t dw3000_read_rawrxtime(struct _dw3000_dev_instance_t * inst){
  */
 
 inline uint64_t dw3000_read_rxtime(struct _dw3000_dev_instance_t * inst){
-    uint64_t time = (uint64_t)  dw3000_read_reg(inst, RX_TIME_ID, RX_TIME_RX_STAMP_OFFSET, RX_TIME_RX_STAMP_LEN) & 0x0FFFFFFFFFFULL;
+    uint64_t time = (uint64_t)  dw3000_rd_rx_stamp(inst) & 0x0FFFFFFFFFFULL;
     return time;
 }
 
@@ -2025,7 +3465,7 @@ inline uint64_t dw3000_read_rxtime(struct _dw3000_dev_instance_t * inst){
  * @return time
  */
 inline uint32_t dw3000_read_rxtime_lo(struct _dw3000_dev_instance_t * inst){
-    uint64_t time = (uint32_t) dw3000_read_reg(inst, RX_TIME_ID, RX_TIME_RX_STAMP_OFFSET, sizeof(uint32_t));
+    uint64_t time = (uint32_t) dw3000_rd_rx_stamp_lo32(inst);
     return time;
 }
 
@@ -2038,7 +3478,7 @@ inline uint32_t dw3000_read_rxtime_lo(struct _dw3000_dev_instance_t * inst){
  *
  */
 inline uint64_t dw3000_read_txrawst(struct _dw3000_dev_instance_t * inst){
-    uint64_t time = (uint64_t) dw3000_read_reg(inst, TX_TIME_ID, TX_TIME_TX_RAWST_OFFSET, TX_TIME_TX_STAMP_LEN) & 0x0FFFFFFFFFFULL;
+    uint64_t time = (uint64_t) dw3000_rd_tx_rawst(inst) & 0x0FFFFFFFFFFULL;
     return time;
 }
 
@@ -2051,7 +3491,7 @@ inline uint64_t dw3000_read_txrawst(struct _dw3000_dev_instance_t * inst){
  *
  */
 inline uint64_t dw3000_read_txtime(struct _dw3000_dev_instance_t * inst){
-    uint64_t time = (uint64_t) dw3000_read_reg(inst, TX_TIME_ID, TX_TIME_TX_STAMP_OFFSET, TX_TIME_TX_STAMP_LEN) & 0x0FFFFFFFFFFULL;
+    uint64_t time = (uint64_t) dw3000_rd_tx_stamp(inst) & 0x0FFFFFFFFFFULL;
     return time;
 }
 
@@ -2063,7 +3503,7 @@ inline uint64_t dw3000_read_txtime(struct _dw3000_dev_instance_t * inst){
  * @return time
  */
 inline uint32_t dw3000_read_txtime_lo(struct _dw3000_dev_instance_t * inst){
-    uint32_t time = (uint32_t) dw3000_read_reg(inst, TX_TIME_ID, TX_TIME_TX_STAMP_OFFSET, sizeof(uint32_t));
+    uint32_t time = (uint32_t) dw3000_rd_tx_stamp_lo32(inst);
     return time;
 }
 
@@ -2080,7 +3520,6 @@ inline uint32_t dw3000_read_txtime_lo(struct _dw3000_dev_instance_t * inst){
 void
 dw3000_configcwmode(struct _dw3000_dev_instance_t * inst, uint8_t chan)
 {
-    int rc;
     if ((chan < 1) || (chan > 7) || (6 == chan)) {
         assert(0);
     }
@@ -2088,13 +3527,11 @@ dw3000_configcwmode(struct _dw3000_dev_instance_t * inst, uint8_t chan)
     /* Lower the speed of the SPI bus before activating CW mode.
      * This is needed because we disable the hiher sysclk and thus
      * dw3000 only support < 2Mbit spi */
-    inst->spi_settings.baudrate = inst->spi_baudrate_low;
-    rc = hal_spi_disable(inst->spi_num);
-    assert(rc == 0);
-    rc = hal_spi_config(inst->spi_num, &inst->spi_settings);
-    assert(rc == 0);
-    rc = hal_spi_enable(inst->spi_num);
-    assert(rc == 0);
+    dw3000_clk_event(inst, DW3000_CLK_EV_TEST);
+    dw3000_spi_tune_noblock(inst);
+#if MYNEWT_VAL(DW3000_MAC_STATS)
+    STATS_SET(inst->stat, SPI_nb_thr, inst->spi_rd_max_noblock);
+#endif
 
     /* disable TX/RX RF block sequencing (needed for cw frame mode) */
     dw3000_phy_disable_sequencing(inst);
@@ -74,6 +74,7 @@ void dw3000_phy_sysclk_XTAL(struct _dw3000_dev_instance_t * inst)
     reg &= (uint8_t)~PMSC_CTRL0_SYSCLKS_19M & (uint8_t)~PMSC_CTRL0_SYSCLKS_125M;
     reg |= (uint8_t) PMSC_CTRL0_SYSCLKS_19M;
     dw3000_write_reg(inst, PMSC_ID, PMSC_CTRL0_OFFSET, reg, sizeof(uint8_t));
+    dw3000_clk_event(inst, DW3000_CLK_EV_XTAL);
 }
 
 /**
@@ -88,6 +89,8 @@ void dw3000_phy_sysclk_PLL(struct _dw3000_dev_instance_t * inst)
     reg &= (uint8_t)~PMSC_CTRL0_SYSCLKS_19M & (uint8_t)~PMSC_CTRL0_SYSCLKS_125M;
     reg |= (uint8_t) PMSC_CTRL0_SYSCLKS_125M;
     dw3000_write_reg(inst, PMSC_ID, PMSC_CTRL0_OFFSET, reg, sizeof(uint8_t));
+    dw3000_clk_event(inst, DW3000_CLK_EV_PLL);
+    dw3000_clk_check_lock(inst);
 }
 
 /**
@@ -126,6 +129,8 @@ void dw3000_phy_sysclk_SEQ(struct _dw3000_dev_instance_t * inst)
     uint8_t reg = (uint8_t) dw3000_read_reg(inst, PMSC_ID, PMSC_CTRL0_OFFSET, sizeof(uint8_t));
     reg &= (uint8_t)~PMSC_CTRL0_SYSCLKS_19M & (uint8_t)~PMSC_CTRL0_SYSCLKS_125M;
     dw3000_write_reg(inst, PMSC_ID, PMSC_CTRL0_OFFSET, reg, sizeof(uint8_t));
+    dw3000_clk_event(inst, DW3000_CLK_EV_SEQ);
+    dw3000_clk_check_lock(inst);
 }
 
 /**
@@ -252,7 +257,7 @@ dw3000_phy_init(struct _dw3000_dev_instance_t * inst, struct uwb_dev_txrf_config
     dw3000_phy_config_txrf(inst, txrf_config);
 
     // Read system register / store local copy
-    inst->sys_cfg_reg = dw3000_read_reg(inst, SYS_CFG_ID, 0, sizeof(uint32_t)) ; // Read sysconfig register
+    inst->sys_cfg_reg = dw3000_read_reg_cached(inst, SYS_CFG_ID, 0, sizeof(uint32_t)) ; // Read sysconfig register
 
     return inst->uwb_dev.status;
 }
@@ -275,6 +280,21 @@ void _dw3000_phy_load_microcode(struct _dw3000_dev_instance_t * inst)
     inst->uwb_dev.status.LDE_enabled = 1;
 }
 
+/**
+ * API to get the LDE algorithm parameters for a PRF, the values written by
+ * dw3000_phy_config_lde.
+ *
+ * @param prf   This is the PRF index (0 or 1) 0 corresponds to 16 and 1 to 64 PRF.
+ * @param cfg1  Set to the 8-bit LDE_CFG1 configuration register.
+ * @param cfg2  Set to the 16-bit LDE_CFG2 configuration tuning register.
+ * @return void
+ */
+void dw3000_phy_lde_params(int prfIndex, uint8_t * cfg1, uint16_t * cfg2)
+{
+    *cfg1 = LDE_PARAM1;
+    *cfg2 = (prfIndex) ? LDE_PARAM3_64 : LDE_PARAM3_16;
+}
+
 /**
  * API to Configure LDE algorithm parameters.
  *
@@ -284,12 +304,12 @@ void _dw3000_phy_load_microcode(struct _dw3000_dev_instance_t * inst)
  */
 void dw3000_phy_config_lde(struct _dw3000_dev_instance_t * inst, int prfIndex)
 {
-    dw3000_write_reg(inst, LDE_IF_ID, LDE_CFG1_OFFSET, LDE_PARAM1, sizeof(uint8_t)); // 8-bit configuration register
+    uint8_t cfg1;
+    uint16_t cfg2;
 
-    if(prfIndex)
-        dw3000_write_reg(inst, LDE_IF_ID, LDE_CFG2_OFFSET, LDE_PARAM3_64, sizeof(uint16_t)); // 16-bit LDE configuration tuning register
-    else
-        dw3000_write_reg(inst, LDE_IF_ID, LDE_CFG2_OFFSET, LDE_PARAM3_16, sizeof(uint16_t));
+    dw3000_phy_lde_params(prfIndex, &cfg1, &cfg2);
+    dw3000_write_reg(inst, LDE_IF_ID, LDE_CFG1_OFFSET, cfg1, sizeof(uint8_t)); // 8-bit configuration register
+    dw3000_write_reg(inst, LDE_IF_ID, LDE_CFG2_OFFSET, cfg2, sizeof(uint16_t)); // 16-bit LDE configuration tuning register
 }
 
 
@@ -372,8 +392,7 @@ void dw3000_phy_rx_reset(struct _dw3000_dev_instance_t * inst)
 void dw3000_phy_forcetrxoff(struct _dw3000_dev_instance_t * inst)
 {
     dpl_error_t err;
-    struct uwb_mac_interface * cbs = NULL;
-    uint32_t mask = dw3000_read_reg(inst, SYS_MASK_ID, 0 , sizeof(uint32_t)) ; // Read set interrupt mask
+    uint32_t mask = dw3000_read_reg_cached(inst, SYS_MASK_ID, 0 , sizeof(uint32_t)) ; // Read set interrupt mask
 
     // Need to beware of interrupts occurring in the middle of following read modify write cycle
     // We can disable the radio, but before the status is cleared an interrupt can be set (e.g. the
@@ -387,7 +406,7 @@ void dw3000_phy_forcetrxoff(struct _dw3000_dev_instance_t * inst)
     }
 
     dw3000_write_reg(inst, SYS_MASK_ID, 0, 0, sizeof(uint32_t)) ; // Clear interrupt mask - so we don't get any unwanted events
-    dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, SYS_CTRL_TRXOFF, sizeof(uint8_t)) ; // Disable the radio
+    dw3000_fast_cmd(inst, DW3000_FCMD_TRXOFF); // Disable the radio
     // Forcing Transceiver off - so we do not want to see any new events that may have happened
     dw3000_write_reg(inst, SYS_STATUS_ID, 0, (SYS_STATUS_ALL_TX | SYS_STATUS_ALL_RX_ERR | SYS_STATUS_ALL_RX_TO | SYS_STATUS_ALL_RX_GOOD| SYS_STATUS_TXBERR), sizeof(uint32_t));
 
@@ -396,12 +415,7 @@ void dw3000_phy_forcetrxoff(struct _dw3000_dev_instance_t * inst)
 
     dw3000_write_reg(inst, SYS_MASK_ID, 0, mask, sizeof(uint32_t)); // Restore mask to what it was
 
-    if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-        SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs!=NULL && cbs->reset_cb)
-                if(cbs->reset_cb((struct uwb_dev*)inst, cbs)) continue;
-            }
-    }
+    dw3000_mac_interface_dispatch(inst, DW3000_CB_RESET, false);
     // Enable/restore interrupts again...
     err = dpl_mutex_release(&inst->mutex);
     assert(err == DPL_OK);
@@ -446,7 +460,7 @@ void dw3000_phy_interrupt_mask(struct _dw3000_dev_instance_t * inst, uint32_t bi
         goto mtx_error;
     }
 
-    mask = dw3000_read_reg(inst, SYS_MASK_ID, 0, sizeof(uint32_t)) ; // Read register
+    mask = dw3000_read_reg_cached(inst, SYS_MASK_ID, 0, sizeof(uint32_t)) ; // Read register
 
     if(enable)
         mask |= bitmask ;
@@ -497,23 +511,15 @@ void dw3000_phy_external_sync(struct _dw3000_dev_instance_t * inst, uint8_t dela
 void
 dw3000_phy_repeated_frames(struct _dw3000_dev_instance_t * inst, uint64_t rate)
 {
-    int rc;
-
     if (!rate) {
         /* Stop sending packets */
         dw3000_write_reg(inst, RF_CONF_ID, 0, 0, sizeof(uint32_t));
         dw3000_write_reg(inst, DIG_DIAG_ID, DIAG_TMC_OFFSET, 0, sizeof(uint8_t));
     } else {
-        /* Lower the speed of the SPI
+        /* Keep the SPI at low speed until the next reset
          * This is needed because we disable the higher sysclk and thus
          * dw3000 only support < 2Mbit spi */
-        inst->spi_settings.baudrate = inst->spi_baudrate_low;
-        rc = hal_spi_disable(inst->spi_num);
-        assert(rc == 0);
-        rc = hal_spi_config(inst->spi_num, &inst->spi_settings);
-        assert(rc == 0);
-        rc = hal_spi_enable(inst->spi_num);
-        assert(rc == 0);
+        dw3000_clk_event(inst, DW3000_CLK_EV_TEST);
 
         printf("PMSC_ID[0]: %"PRIx32"\n", (uint32_t)dw3000_read_reg(inst, PMSC_ID, PMSC_CTRL0_OFFSET, sizeof(uint32_t)));
         printf("PMSC_ID[1]: %"PRIx32"\n", (uint32_t)dw3000_read_reg(inst, PMSC_ID, PMSC_CTRL1_OFFSET, sizeof(uint32_t)));
@@ -537,7 +543,7 @@ dw3000_phy_repeated_frames(struct _dw3000_dev_instance_t * inst, uint64_t rate)
                          (uint8_t)(DIAG_TMC_TX_PSTM), sizeof(uint8_t));
 
         /* Trigger first frame - Needed?? */
-        dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, SYS_CTRL_TXSTRT, sizeof(uint8_t));
+        dw3000_fast_cmd(inst, DW3000_FCMD_TX);
     }
 }
 
@@ -0,0 +1,178 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw3000_rxfilter.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2020
+ * @brief Software frame filter
+ *
+ * @details Compiles the rules of the software frame filter into a program and
+ * evaluates it on a frame header. Nothing here touches the device, the instance
+ * side is in dw3000_mac.c.
+ */
+
+#include <string.h>
+#include <dpl/dpl.h>
+#include <dw3000-c0/dw3000_rxfilter.h>
+
+#if MYNEWT_VAL(DW3000_RX_FILTER_MAX)
+_Static_assert(MYNEWT_VAL(DW3000_RX_FILTER_MAX) <= 0xFF && MYNEWT_VAL(DW3000_RX_FILTER_RULES) <= 0xFF,
+               "DW3000_RX_FILTER_MAX and DW3000_RX_FILTER_RULES must fit in a byte");
+
+/**
+ * API to compile rules into a software frame filter program. Each rule is a conjunction of
+ * range predicates over the frame length and up to four little endian frame bytes. The rules
+ * are tried in order and the first one matching decides whether the frame is accepted, frames
+ * matching no rule get the default action. Several rules with the same action express an or,
+ * e.g. a set of message codes. Length predicates that always hold are dropped and rules with
+ * a predicate that never holds are left out of the program. A frame predicate is kept even
+ * if it holds for any value, a frame too short to contain its bytes does not match it. The
+ * hit counters of the program are cleared.
+ *
+ * @param prog      Program, not to be in use by dw3000_rx_filter_eval.
+ * @param rules     Rules, compiled, not referenced afterwards.
+ * @param nrules    Number of rules, at most DW3000_RX_FILTER_RULES.
+ * @param accept    Accept frames matching no rule if true, reject them otherwise.
+ * @return int      DPL_OK, DPL_EINVAL if a rule is invalid, DPL_ENOMEM if the program doesn't
+ *                  fit in DW3000_RX_FILTER_MAX instructions.
+ */
+int
+dw3000_rx_filter_build(dw3000_rx_filter_prog_t * prog, const dw3000_rx_filter_rule_t * rules, uint8_t nrules, bool accept)
+{
+    uint16_t hdr_len = 0;
+    uint8_t n = 0;
+
+    prog->count = 0;
+    if (nrules > MYNEWT_VAL(DW3000_RX_FILTER_RULES) || (nrules && rules == NULL)) {
+        return DPL_EINVAL;
+    }
+
+    for (int r = 0;r < nrules;r++) {
+        const dw3000_rx_filter_rule_t * rule = &rules[r];
+        uint16_t rule_hdr = hdr_len;
+        uint8_t first = n;
+
+        for (int p = 0;p < rule->npreds;p++) {
+            const dw3000_rx_filter_pred_t * pred = &rule->preds[p];
+            dw3000_rx_filter_insn_t * in;
+            uint32_t mask = pred->mask;
+
+            if (pred->src == DW3000_RX_FILTER_FRAME) {
+                if (pred->len == 0 || pred->len > sizeof(uint32_t)) {
+                    return DPL_EINVAL;
+                }
+                if (pred->len < sizeof(uint32_t)) {
+                    mask &= (1UL << (8 * pred->len)) - 1;
+                }
+            } else if (pred->src != DW3000_RX_FILTER_LEN) {
+                return DPL_EINVAL;
+            } else if (pred->min == 0 && pred->max >= mask) {
+                /* Holds for any frame */
+                continue;
+            }
+            if (pred->min > pred->max || pred->min > mask) {
+                /* Never holds, leave the rule out */
+                n = first;
+                hdr_len = rule_hdr;
+                goto next_rule;
+            }
+            if (n >= MYNEWT_VAL(DW3000_RX_FILTER_MAX)) {
+                return DPL_ENOMEM;
+            }
+            in = &prog->insn[n++];
+            in->len = (pred->src == DW3000_RX_FILTER_FRAME) ? pred->len : 0;
+            in->offset = pred->offset;
+            in->rule = r;
+            in->last = 0;
+            in->mask = mask;
+            in->min = pred->min;
+            in->max = (pred->max < mask) ? pred->max : mask;
+            if (in->len && in->offset + in->len > hdr_len) {
+                hdr_len = in->offset + in->len;
+            }
+        }
+        if (n == first) {
+            /* Every predicate holds, match on the frame length without testing it */
+            if (n >= MYNEWT_VAL(DW3000_RX_FILTER_MAX)) {
+                return DPL_ENOMEM;
+            }
+            prog->insn[n] = (dw3000_rx_filter_insn_t){.rule = r, .mask = 0, .min = 0, .max = 0};
+            n++;
+        }
+        prog->insn[n - 1].last = 1 + (rule->accept != 0);
+        for (int i = first;i < n;i++) {
+            prog->insn[i].fail = n;
+        }
+next_rule:
+        ;
+    }
+
+    memset(prog->hits, 0, sizeof(prog->hits));
+    prog->default_hits = 0;
+    prog->count = n;
+    prog->hdr_len = hdr_len;
+    prog->accept = accept;
+    return DPL_OK;
+}
+
+/**
+ * API to run a software frame filter program on a frame header, the hit counter of the
+ * matching rule, or the default one, is incremented.
+ *
+ * @param prog      Program built with dw3000_rx_filter_build.
+ * @param frame     First bytes of the frame.
+ * @param have      Number of bytes in frame, frame predicates beyond them don't hold.
+ * @param frame_len Frame length without crc.
+ * @return bool true if the frame is accepted
+ */
+bool
+dw3000_rx_filter_eval(dw3000_rx_filter_prog_t * prog, const uint8_t * frame, uint16_t have, uint16_t frame_len)
+{
+    uint8_t pc = 0;
+
+    while (pc < prog->count) {
+        const dw3000_rx_filter_insn_t * in = &prog->insn[pc];
+        uint32_t data = frame_len;
+
+        if (in->len) {
+            if (in->offset + in->len > have) {
+                pc = in->fail;
+                continue;
+            }
+            data = 0;
+            for (int j = in->offset + in->len - 1;j >= in->offset;j--) {
+                data = (data << 8) | frame[j];
+            }
+        }
+        data &= in->mask;
+        if (data < in->min || data > in->max) {
+            pc = in->fail;
+            continue;
+        }
+        if (in->last) {
+            prog->hits[in->rule]++;
+            return in->last > 1;
+        }
+        pc++;
+    }
+    prog->default_hits++;
+    return prog->accept;
+}
+#endif
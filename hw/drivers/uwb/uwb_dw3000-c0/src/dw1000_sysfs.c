@@ -152,7 +152,7 @@ static ssize_t cmd_store(struct kobject *kobj,
 
     if (!strcmp(attr->attr.name, "cw")) {
         dw3000_write_reg(inst, SYS_MASK_ID, 0, 0, sizeof(uint32_t));
-        dw3000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, SYS_CTRL_TRXOFF, sizeof(uint8_t));
+        dw3000_fast_cmd(inst, DW3000_FCMD_TRXOFF);
         dw3000_configcwmode(inst, inst->uwb_dev.config.channel);
         slog("Device now in CW mode on ch %d. Reset to continue\n",
              inst->uwb_dev.config.channel);
@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw3000_test.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2020
+ * @brief Host test harness
+ *
+ * @details Assertions and result reporting shared by the host tests of the
+ * driver, each test is a single executable added with dw3000_add_test in
+ * test/CMakeLists.txt. Failed assertions are printed and counted, the test
+ * keeps running.
+ */
+
+#ifndef _DW3000_TEST_H_
+#define _DW3000_TEST_H_
+
+#include <stdio.h>
+
+//! Exit code reported as skipped, see SKIP_RETURN_CODE in dw3000_add_test
+#define TEST_SKIPPED    (77)
+
+//! Check a condition, a failure is printed and counted
+#define TEST_ASSERT(_C) do { \
+        if (!(_C)) { \
+            printf("%s:%d: %s failed\n", __FILE__, __LINE__, #_C); \
+            test_failures++; \
+        } \
+    } while (0)
+
+//! main of a test whose feature isn't enabled in the syscfg
+#define TEST_SKIP_MAIN() \
+    int main(int argc, char **argv) { return TEST_SKIPPED; }
+
+static int test_failures;
+
+/**
+ * Print the outcome of a test.
+ *
+ * @param name  Name of the test.
+ * @return int  Exit code of the test, 0 if all assertions held, 1 otherwise
+ */
+static inline int
+test_result(const char * name)
+{
+    if (test_failures) {
+        printf("%s: %d failures\n", name, test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+#endif /* _DW3000_TEST_H_ */
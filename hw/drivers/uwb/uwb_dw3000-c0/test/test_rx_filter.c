@@ -0,0 +1,214 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file test_rx_filter.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2020
+ * @brief Software frame filter test
+ *
+ * @details Builds software frame filter programs and evaluates them on
+ * synthetic frame headers: rule order and fail targets, rules left out by
+ * the compiler, short frames, the default action and the hit counters.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <syscfg/syscfg.h>
+#include "dw3000_test.h"
+
+#if MYNEWT_VAL(DW3000_RX_FILTER_MAX) >= 4 && MYNEWT_VAL(DW3000_RX_FILTER_RULES) >= 3
+
+#include <dpl/dpl.h>
+#include <dw3000-c0/dw3000_rxfilter.h>
+
+#define TEST_PRED_FRAME(_O, _L, _M, _MIN, _MAX) \
+    {.src = DW3000_RX_FILTER_FRAME, .offset = (_O), .len = (_L), .mask = (_M), .min = (_MIN), .max = (_MAX)}
+#define TEST_PRED_LEN(_MIN, _MAX) \
+    {.src = DW3000_RX_FILTER_LEN, .mask = 0xFFFF, .min = (_MIN), .max = (_MAX)}
+#define TEST_RULE(_P, _A) {.preds = (_P), .npreds = sizeof(_P)/sizeof((_P)[0]), .accept = (_A)}
+
+static dw3000_rx_filter_prog_t test_prog;
+
+/* Frame control 0x8841, sequence number, then a message code at offset 9 */
+static const uint8_t test_frame[] = {0x41, 0x88, 0x01, 0xCA, 0xDE, 0xFF, 0xFF, 0x34, 0x12, 0x25, 0x00};
+
+static void
+test_default_action(void)
+{
+    TEST_ASSERT(dw3000_rx_filter_build(&test_prog, NULL, 0, false) == DPL_OK);
+    TEST_ASSERT(test_prog.count == 0);
+    TEST_ASSERT(test_prog.hdr_len == 0);
+    TEST_ASSERT(!dw3000_rx_filter_eval(&test_prog, test_frame, 0, sizeof(test_frame)));
+    TEST_ASSERT(test_prog.default_hits == 1);
+
+    TEST_ASSERT(dw3000_rx_filter_build(&test_prog, NULL, 0, true) == DPL_OK);
+    TEST_ASSERT(test_prog.default_hits == 0);
+    TEST_ASSERT(dw3000_rx_filter_eval(&test_prog, test_frame, 0, sizeof(test_frame)));
+    TEST_ASSERT(test_prog.default_hits == 1);
+}
+
+static void
+test_fail_targets(void)
+{
+    /* Data frames with message code 0x20..0x2F are accepted, other short frames rejected */
+    static const dw3000_rx_filter_pred_t code[] = {
+        TEST_PRED_FRAME(0, 2, 0x0007, 0x0001, 0x0001),
+        TEST_PRED_FRAME(9, 1, 0xFF, 0x20, 0x2F),
+    };
+    static const dw3000_rx_filter_pred_t shortlen[] = {
+        TEST_PRED_LEN(0, 12),
+    };
+    static const dw3000_rx_filter_rule_t rules[] = {
+        TEST_RULE(code, 1),
+        TEST_RULE(shortlen, 0),
+    };
+    uint8_t frame[sizeof(test_frame)];
+
+    TEST_ASSERT(dw3000_rx_filter_build(&test_prog, rules, 2, true) == DPL_OK);
+    TEST_ASSERT(test_prog.count == 3);
+    TEST_ASSERT(test_prog.hdr_len == 10);
+    /* Both predicates of the first rule fail to the second rule */
+    TEST_ASSERT(test_prog.insn[0].fail == 2 && test_prog.insn[1].fail == 2);
+    TEST_ASSERT(test_prog.insn[2].fail == 3);
+
+    TEST_ASSERT(dw3000_rx_filter_eval(&test_prog, test_frame, 10, sizeof(test_frame)));
+    TEST_ASSERT(test_prog.hits[0] == 1);
+
+    /* Second predicate fails, the short frame is rejected by the second rule */
+    memcpy(frame, test_frame, sizeof(frame));
+    frame[9] = 0x30;
+    TEST_ASSERT(!dw3000_rx_filter_eval(&test_prog, frame, 10, sizeof(frame)));
+    TEST_ASSERT(test_prog.hits[1] == 1);
+
+    /* First predicate fails, a long frame falls through to the default */
+    frame[0] = 0x43;
+    TEST_ASSERT(dw3000_rx_filter_eval(&test_prog, frame, 10, 40));
+    TEST_ASSERT(test_prog.default_hits == 1);
+    TEST_ASSERT(test_prog.hits[0] == 1 && test_prog.hits[1] == 1);
+}
+
+static void
+test_rule_removal(void)
+{
+    /* The first rule can never match and is left out, hits keep the rule numbers */
+    static const dw3000_rx_filter_pred_t never[] = {
+        TEST_PRED_FRAME(0, 1, 0xFF, 0x41, 0x41),
+        TEST_PRED_FRAME(9, 1, 0x0F, 0x10, 0x1F),
+    };
+    static const dw3000_rx_filter_pred_t always[] = {
+        TEST_PRED_LEN(0, 0xFFFF),
+    };
+    static const dw3000_rx_filter_pred_t code[] = {
+        TEST_PRED_FRAME(9, 1, 0xFF, 0x25, 0x25),
+    };
+    static const dw3000_rx_filter_rule_t rules[] = {
+        TEST_RULE(never, 1),
+        TEST_RULE(code, 0),
+        TEST_RULE(always, 1),
+    };
+
+    TEST_ASSERT(dw3000_rx_filter_build(&test_prog, rules, 3, false) == DPL_OK);
+    /* One instruction for the code, one for the rule whose predicate always holds */
+    TEST_ASSERT(test_prog.count == 2);
+    TEST_ASSERT(test_prog.hdr_len == 10);
+    TEST_ASSERT(test_prog.insn[0].rule == 1 && test_prog.insn[0].fail == 1);
+    TEST_ASSERT(test_prog.insn[1].rule == 2 && test_prog.insn[1].len == 0);
+
+    TEST_ASSERT(!dw3000_rx_filter_eval(&test_prog, test_frame, 10, sizeof(test_frame)));
+    TEST_ASSERT(test_prog.hits[0] == 0 && test_prog.hits[1] == 1);
+
+    /* Everything else is caught by the last rule, the default is never reached */
+    TEST_ASSERT(dw3000_rx_filter_eval(&test_prog, test_frame, 2, 2));
+    TEST_ASSERT(test_prog.hits[2] == 1);
+    TEST_ASSERT(test_prog.default_hits == 0);
+}
+
+static void
+test_short_frames(void)
+{
+    /* A frame predicate holding for any value still needs the frame bytes */
+    static const dw3000_rx_filter_pred_t any[] = {
+        TEST_PRED_FRAME(7, 2, 0, 0, 0xFFFF),
+    };
+    static const dw3000_rx_filter_rule_t rules[] = {
+        TEST_RULE(any, 0),
+    };
+
+    TEST_ASSERT(dw3000_rx_filter_build(&test_prog, rules, 1, true) == DPL_OK);
+    TEST_ASSERT(test_prog.count == 1);
+    TEST_ASSERT(test_prog.hdr_len == 9);
+    TEST_ASSERT(!dw3000_rx_filter_eval(&test_prog, test_frame, 9, sizeof(test_frame)));
+    TEST_ASSERT(dw3000_rx_filter_eval(&test_prog, test_frame, 8, 8));
+    TEST_ASSERT(dw3000_rx_filter_eval(&test_prog, test_frame, 0, 0));
+    TEST_ASSERT(test_prog.hits[0] == 1 && test_prog.default_hits == 2);
+}
+
+static void
+test_invalid(void)
+{
+    static const dw3000_rx_filter_pred_t zero[] = {
+        TEST_PRED_FRAME(0, 0, 0xFF, 0, 0),
+    };
+    static const dw3000_rx_filter_pred_t wide[] = {
+        TEST_PRED_FRAME(0, 5, 0xFF, 0, 0),
+    };
+    static const dw3000_rx_filter_pred_t src[] = {
+        {.src = 7, .mask = 0xFF},
+    };
+    static dw3000_rx_filter_pred_t many[MYNEWT_VAL(DW3000_RX_FILTER_MAX) + 1];
+    dw3000_rx_filter_rule_t rule;
+
+    rule = (dw3000_rx_filter_rule_t)TEST_RULE(zero, 1);
+    TEST_ASSERT(dw3000_rx_filter_build(&test_prog, &rule, 1, true) == DPL_EINVAL);
+    TEST_ASSERT(test_prog.count == 0);
+    rule = (dw3000_rx_filter_rule_t)TEST_RULE(wide, 1);
+    TEST_ASSERT(dw3000_rx_filter_build(&test_prog, &rule, 1, true) == DPL_EINVAL);
+    rule = (dw3000_rx_filter_rule_t)TEST_RULE(src, 1);
+    TEST_ASSERT(dw3000_rx_filter_build(&test_prog, &rule, 1, true) == DPL_EINVAL);
+    TEST_ASSERT(dw3000_rx_filter_build(&test_prog, NULL, 1, true) == DPL_EINVAL);
+    TEST_ASSERT(dw3000_rx_filter_build(&test_prog, &rule, MYNEWT_VAL(DW3000_RX_FILTER_RULES) + 1, true) == DPL_EINVAL);
+
+    for (int i = 0;i < sizeof(many)/sizeof(many[0]);i++) {
+        many[i] = (dw3000_rx_filter_pred_t)TEST_PRED_FRAME(i, 1, 0xFF, 0, 0x7F);
+    }
+    rule = (dw3000_rx_filter_rule_t)TEST_RULE(many, 1);
+    TEST_ASSERT(dw3000_rx_filter_build(&test_prog, &rule, 1, true) == DPL_ENOMEM);
+    TEST_ASSERT(test_prog.count == 0);
+}
+
+int
+main(int argc, char **argv)
+{
+    test_default_action();
+    test_fail_targets();
+    test_rule_removal();
+    test_short_frames();
+    test_invalid();
+
+    return test_result("test_rx_filter");
+}
+
+#else
+
+/* Skipped, the software frame filter isn't built or too small for the test */
+TEST_SKIP_MAIN()
+
+#endif
@@ -0,0 +1,327 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file test_spidev.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2020
+ * @brief spidev backend test
+ *
+ * @details Runs the spidev backend of the hal against a stub spidev device.
+ * open, ioctl and close are wrapped at link time, the stub decodes the
+ * command header of each SPI_IOC_MESSAGE and reads or writes a fake
+ * register file.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <syscfg/syscfg.h>
+#include "dw3000_test.h"
+
+#if MYNEWT_VAL(DW3000_HAL_SPIDEV)
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include <dpl/dpl.h>
+#include <hal/hal_spi.h>
+#include <dw3000-c0/dw3000_dev.h>
+#include <dw3000-c0/dw3000_hal.h>
+
+#define TEST_FAKE_FD        (1000)
+#define TEST_REG_SIZE       (0x400)
+
+//! State of the stub spidev device
+static struct {
+    int open_fail;              //!< Fail the next open
+    int is_open;                //!< Device currently open
+    char path[32];              //!< Path of the last open
+    uint8_t mode;               //!< Last SPI_IOC_WR_MODE
+    uint8_t lsb_first;          //!< Last SPI_IOC_WR_LSB_FIRST
+    uint32_t speed;             //!< Last SPI_IOC_WR_MAX_SPEED_HZ
+    int segments;               //!< Segments of the last message
+    uint32_t msg_speed;         //!< speed_hz of the last message
+    uint8_t regs[0x40][TEST_REG_SIZE];  //!< Fake register file
+} test_spidev;
+
+int __real_open(const char *path, int flags, ...);
+int __real_ioctl(int fd, unsigned long req, ...);
+int __real_close(int fd);
+
+int
+__wrap_open(const char *path, int flags, ...)
+{
+    if (strncmp(path, "/dev/spidev", 11)) {
+        va_list ap;
+        int mode;
+        va_start(ap, flags);
+        mode = va_arg(ap, int);
+        va_end(ap);
+        return __real_open(path, flags, mode);
+    }
+    if (test_spidev.open_fail) {
+        return -1;
+    }
+    strncpy(test_spidev.path, path, sizeof(test_spidev.path) - 1);
+    test_spidev.is_open = 1;
+    return TEST_FAKE_FD;
+}
+
+int
+__wrap_close(int fd)
+{
+    if (fd != TEST_FAKE_FD) {
+        return __real_close(fd);
+    }
+    test_spidev.is_open = 0;
+    return 0;
+}
+
+/**
+ * Carry out one SPI_IOC_MESSAGE. The header has to be a segment of its own,
+ * followed by at most one data segment.
+ */
+static int
+test_spidev_message(struct spi_ioc_transfer * xfer, int n)
+{
+    const uint8_t * header = (const uint8_t *)(uintptr_t)xfer[0].tx_buf;
+    uint16_t sub = 0;
+    uint8_t reg, is_write;
+
+    test_spidev.segments = n;
+    test_spidev.msg_speed = xfer[0].speed_hz;
+    if (n < 1 || n > 2 || !header || xfer[0].rx_buf || xfer[0].len < 1 || xfer[0].len > 3) {
+        return -1;
+    }
+    is_write = header[0] >> 7;
+    reg = header[0] & 0x3F;
+    if (xfer[0].len > 1) {
+        sub = header[1] & 0x7F;
+    }
+    if (xfer[0].len > 2) {
+        sub |= (uint16_t)header[2] << 7;
+    }
+    if (n == 1) {
+        return xfer[0].len;
+    }
+    if (sub + xfer[1].len > TEST_REG_SIZE) {
+        return -1;
+    }
+    if (is_write) {
+        if (!xfer[1].tx_buf || xfer[1].rx_buf) {
+            return -1;
+        }
+        memcpy(&test_spidev.regs[reg][sub], (void*)(uintptr_t)xfer[1].tx_buf, xfer[1].len);
+    } else {
+        if (xfer[1].tx_buf || !xfer[1].rx_buf) {
+            return -1;
+        }
+        memcpy((void*)(uintptr_t)xfer[1].rx_buf, &test_spidev.regs[reg][sub], xfer[1].len);
+    }
+    return xfer[0].len + xfer[1].len;
+}
+
+int
+__wrap_ioctl(int fd, unsigned long req, ...)
+{
+    va_list ap;
+    void * arg;
+
+    va_start(ap, req);
+    arg = va_arg(ap, void *);
+    va_end(ap);
+
+    if (fd != TEST_FAKE_FD) {
+        return __real_ioctl(fd, req, arg);
+    }
+    if (!test_spidev.is_open) {
+        return -1;
+    }
+    switch (req) {
+    case SPI_IOC_WR_MODE:
+        test_spidev.mode = *(uint8_t *)arg;
+        return 0;
+    case SPI_IOC_WR_LSB_FIRST:
+        test_spidev.lsb_first = *(uint8_t *)arg;
+        return 0;
+    case SPI_IOC_WR_BITS_PER_WORD:
+        return (*(uint8_t *)arg == 8) ? 0 : -1;
+    case SPI_IOC_WR_MAX_SPEED_HZ:
+        test_spidev.speed = *(uint32_t *)arg;
+        return 0;
+    default:
+        break;
+    }
+    if (_IOC_TYPE(req) == SPI_IOC_MAGIC && _IOC_NR(req) == 0 && _IOC_DIR(req) == _IOC_WRITE) {
+        return test_spidev_message(arg, _IOC_SIZE(req) / sizeof(struct spi_ioc_transfer));
+    }
+    return -1;
+}
+
+static struct dpl_sem test_spi_sem;
+static dw3000_dev_instance_t test_inst;
+
+static dw3000_dev_instance_t *
+test_inst_init(uint8_t data_mode)
+{
+    dw3000_dev_instance_t * inst = &test_inst;
+
+    hal_dw3000_spidev_close(inst);
+    memset(inst, 0, sizeof(*inst));
+    inst->spidev_fd = -1;
+    inst->spi_sem = &test_spi_sem;
+    inst->spi_num = 1;
+    inst->ss_pin = 0;
+    inst->spi_baudrate = 8000;
+    inst->spi_baudrate_low = 2000;
+    inst->clk_state = DW3000_CLK_PLL;
+    inst->spi_settings.data_order = HAL_SPI_MSB_FIRST;
+    inst->spi_settings.data_mode = data_mode;
+    inst->spi_settings.baudrate = inst->spi_baudrate;
+    inst->spi_settings.word_size = HAL_SPI_WORD_SIZE_8BIT;
+    return inst;
+}
+
+/* Header as dw3000_read/dw3000_write build it */
+static uint8_t
+test_header(uint8_t * header, uint8_t is_write, uint8_t reg, uint16_t sub)
+{
+    header[0] = is_write << 7 | (sub != 0) << 6 | reg;
+    header[1] = (sub > 0x7F) << 7 | (uint8_t)(sub);
+    header[2] = (uint8_t)(sub >> 7);
+    return sub ? ((sub > 0x7F) ? 3 : 2) : 1;
+}
+
+static void
+test_roundtrip(void)
+{
+    dw3000_dev_instance_t * inst = test_inst_init(HAL_SPI_MODE0);
+    uint8_t header[3], len;
+    uint8_t wr[64], rd[64];
+
+    for (int i = 0;i < sizeof(wr);i++) {
+        wr[i] = i ^ 0x5A;
+    }
+    len = test_header(header, 1, 0x25, 0x1C0);
+    TEST_ASSERT(hal_dw3000_write(inst, header, len, wr, sizeof(wr)) == DPL_OK);
+    TEST_ASSERT(test_spidev.is_open);
+    TEST_ASSERT(!strcmp(test_spidev.path, "/dev/spidev1.0"));
+    TEST_ASSERT(test_spidev.segments == 2);
+    TEST_ASSERT(test_spidev.msg_speed == 8000 * 1000);
+    TEST_ASSERT(!memcmp(&test_spidev.regs[0x25][0x1C0], wr, sizeof(wr)));
+
+    memset(rd, 0, sizeof(rd));
+    len = test_header(header, 0, 0x25, 0x1C0);
+    TEST_ASSERT(hal_dw3000_read(inst, header, len, rd, sizeof(rd)) == DPL_OK);
+    TEST_ASSERT(!memcmp(rd, wr, sizeof(wr)));
+
+    /* Noblock reads run as one synchronous message */
+    memset(rd, 0, sizeof(rd));
+    len = test_header(header, 0, 0x25, 0x1C8);
+    TEST_ASSERT(hal_dw3000_read_noblock(inst, header, len, rd, 8) == DPL_OK);
+    TEST_ASSERT(!memcmp(rd, &wr[8], 8));
+
+    /* Short subaddress and plain register */
+    len = test_header(header, 1, 0x03, 0x10);
+    TEST_ASSERT(len == 2);
+    TEST_ASSERT(hal_dw3000_write(inst, header, len, wr, 4) == DPL_OK);
+    TEST_ASSERT(!memcmp(&test_spidev.regs[0x03][0x10], wr, 4));
+    len = test_header(header, 0, 0x03, 0);
+    TEST_ASSERT(hal_dw3000_read(inst, header, len, rd, 4) == DPL_OK);
+    TEST_ASSERT(!memcmp(rd, test_spidev.regs[0x03], 4));
+    TEST_ASSERT(!inst->uwb_dev.status.spi_error);
+}
+
+static void
+test_header_only(void)
+{
+    dw3000_dev_instance_t * inst = test_inst_init(HAL_SPI_MODE0);
+    uint8_t header[3], len;
+
+    len = test_header(header, 1, 0x0D, 0);
+    TEST_ASSERT(hal_dw3000_write(inst, header, len, 0, 0) == DPL_OK);
+    TEST_ASSERT(test_spidev.segments == 1);
+}
+
+static void
+test_mode(void)
+{
+    static const struct {
+        uint8_t data_mode;
+        uint8_t spi_mode;
+    } modes[] = {
+        {HAL_SPI_MODE0, SPI_MODE_0},
+        {HAL_SPI_MODE1, SPI_MODE_1},
+        {HAL_SPI_MODE2, SPI_MODE_2},
+        {HAL_SPI_MODE3, SPI_MODE_3},
+    };
+    uint8_t header[3], rd[4], len;
+
+    for (int i = 0;i < sizeof(modes)/sizeof(modes[0]);i++) {
+        dw3000_dev_instance_t * inst = test_inst_init(modes[i].data_mode);
+        len = test_header(header, 0, 0, 0);
+        TEST_ASSERT(hal_dw3000_read(inst, header, len, rd, sizeof(rd)) == DPL_OK);
+        TEST_ASSERT(test_spidev.mode == modes[i].spi_mode);
+        TEST_ASSERT(test_spidev.lsb_first == 0);
+        TEST_ASSERT(test_spidev.speed == 8000 * 1000);
+    }
+}
+
+static void
+test_open_fail(void)
+{
+    dw3000_dev_instance_t * inst = test_inst_init(HAL_SPI_MODE0);
+    uint8_t header[3], rd[4], len;
+
+    test_spidev.open_fail = 1;
+    len = test_header(header, 0, 0, 0);
+    hal_dw3000_read(inst, header, len, rd, sizeof(rd));
+    TEST_ASSERT(inst->uwb_dev.status.spi_error);
+    TEST_ASSERT(inst->spidev_fd < 0);
+    test_spidev.open_fail = 0;
+
+    /* Opened again on the next transfer */
+    inst->uwb_dev.status.spi_error = 0;
+    hal_dw3000_read(inst, header, len, rd, sizeof(rd));
+    TEST_ASSERT(!inst->uwb_dev.status.spi_error);
+    TEST_ASSERT(inst->spidev_fd == TEST_FAKE_FD);
+}
+
+int
+main(int argc, char **argv)
+{
+    dpl_sem_init(&test_spi_sem, 1);
+
+    test_roundtrip();
+    test_header_only();
+    test_mode();
+    test_open_fail();
+    hal_dw3000_spidev_close(&test_inst);
+
+    return test_result("test_spidev");
+}
+
+#else
+
+/* Skipped, the spidev backend isn't built */
+TEST_SKIP_MAIN()
+
+#endif
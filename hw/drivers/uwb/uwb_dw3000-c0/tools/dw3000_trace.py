@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+#
+
+"""Decode a dw3000 trace ring captured with the "dw3000 trace" console command.
+
+The input is either the console output (a json header line followed by one
+24 hex character line per record) or a raw binary copy of inst->trace[] (use
+--bin, oldest record first). Register and status bit names are taken from
+dw3000_regs.h so the decoder follows the driver headers.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+REC = struct.Struct('<IBBHI')
+
+TRACE_SPI = 0x01
+TRACE_SPI_END = 0x02
+TRACE_IRQ = 0x03
+TRACE_IRQ_END = 0x04
+TRACE_WRITE = 0x40
+TRACE_NOBLOCK = 0x80
+
+DEFAULT_REGS = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                            '..', 'include', 'dw3000-c0', 'dw3000_regs.h')
+
+
+def load_regs(path):
+    regs = {}
+    status = []
+    try:
+        with open(path) as f:
+            for line in f:
+                m = re.match(r'#define\s+(\w+)_ID\s+(0x[0-9A-Fa-f]+)\b', line)
+                if m:
+                    regs.setdefault(int(m.group(2), 16), m.group(1))
+                    continue
+                m = re.match(r'#define\s+SYS_STATUS_(\w+)\s+(0x[0-9A-Fa-f]+)UL\b', line)
+                if m and not m.group(1).startswith(('MASK', 'ALL', 'CLEAR')):
+                    bit = int(m.group(2), 16)
+                    if bit and not bit & (bit - 1):
+                        status.append((bit, m.group(1)))
+    except OSError:
+        pass
+    return regs, status
+
+
+def parse_text(lines):
+    hdr = {}
+    recs = []
+    for line in lines:
+        line = line.strip()
+        if line.startswith('{'):
+            hdr = json.loads(line)
+            continue
+        if re.fullmatch(r'[0-9A-Fa-f]{24}', line):
+            recs.append(REC.unpack(bytes.fromhex(line)))
+    return hdr, recs
+
+
+def parse_bin(data):
+    n = len(data) // REC.size
+    return [REC.unpack_from(data, i * REC.size) for i in range(n)]
+
+
+def decode_spi(typ, a, b, c, regs):
+    wr = 'wr' if a & 0x80 else 'rd'
+    reg = a & 0x3F
+    sub = 0
+    if a & 0x40:
+        sub = b & 0x7F
+        if b & 0x80:
+            sub |= (b >> 8) << 7
+    name = regs.get(reg, '0x%02X' % reg)
+    nb = ' nb' if typ & TRACE_NOBLOCK else ''
+    return 'spi %s %s+0x%X len=%d%s' % (wr, name, sub, c, nb)
+
+
+def decode_status(hi, lo, status):
+    bits = [n for bit, n in status if lo & bit]
+    return 'irq status=0x%02X%08X %s' % (hi, lo, '|'.join(bits))
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    p.add_argument('file', nargs='?', help='capture file (default stdin)')
+    p.add_argument('--bin', action='store_true', help='input is a raw binary ring dump')
+    p.add_argument('--usec-per-64k-ticks', type=int, default=None,
+                   help='timer scale, overrides the value in the header')
+    p.add_argument('--regs', default=DEFAULT_REGS, help='path to dw3000_regs.h')
+    args = p.parse_args()
+
+    regs, status = load_regs(args.regs)
+    if args.bin:
+        data = open(args.file, 'rb').read() if args.file else sys.stdin.buffer.read()
+        hdr, recs = {}, parse_bin(data)
+    else:
+        f = open(args.file) if args.file else sys.stdin
+        hdr, recs = parse_text(f)
+
+    scale = args.usec_per_64k_ticks or hdr.get('usec_per_64k_ticks') or 65536
+    def usec(ticks):
+        return (ticks * scale) / 65536.0
+
+    t0 = recs[0][0] if recs else 0
+    spi_start = None
+    irq_start = None
+    for utime, typ, a, b, c in recs:
+        t = (utime - t0) & 0xFFFFFFFF
+        kind = typ & 0x3F
+        if kind == TRACE_SPI:
+            spi_start = utime
+            desc = decode_spi(typ, a, b, c, regs)
+        elif kind == TRACE_SPI_END:
+            desc = 'spi end'
+            if spi_start is not None:
+                desc += ' (%.1fus)' % usec((utime - spi_start) & 0xFFFFFFFF)
+            spi_start = None
+        elif kind == TRACE_IRQ:
+            irq_start = utime
+            desc = decode_status(a, c, status)
+        elif kind == TRACE_IRQ_END:
+            desc = 'irq end'
+            if irq_start is not None:
+                desc += ' (%.1fus)' % usec((utime - irq_start) & 0xFFFFFFFF)
+            irq_start = None
+        else:
+            desc = 'type=0x%02X a=0x%02X b=0x%04X c=0x%08X' % (typ, a, b, c)
+        print('%12.1f  %s' % (usec(t), desc))
+
+
+if __name__ == '__main__':
+    main()
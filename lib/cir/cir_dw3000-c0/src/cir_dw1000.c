@@ -488,6 +488,9 @@ void cir_dw3000_pkg_init(void)
         inst->uwb_dev.cir = (struct cir_instance*)inst->cir;
         inst->cir->cir_inst.cir_funcs = &cir_dw3000_funcs;
         uwb_mac_append_interface(udev, &cbs[i]);
+#if MYNEWT_VAL(DW3000_CB_DISPATCH_MAX)
+        dw3000_mac_interface_update(inst);
+#endif
     }
 #endif // MYNEWT_VAL(CIR_ENABLED)
 }
@@ -517,6 +520,9 @@ int cir_dw3000_pkg_down(int reason)
             continue;
         }
         uwb_mac_remove_interface(udev, cbs[i].id);
+#if MYNEWT_VAL(DW3000_CB_DISPATCH_MAX)
+        dw3000_mac_interface_update((dw3000_dev_instance_t *)udev);
+#endif
         cir_dw3000_free(cir);
     }
 